@@ -28,14 +28,24 @@
 #define SCREEN_RESOLUTION 128
 #define WINDOW_RATIO      6
 #define WINDOW_RESOLUTION ( SCREEN_RESOLUTION * WINDOW_RATIO )
+#define TRACE_RECORDS     0x100000 // Instructions kept in build/trace.bin
+#define REWIND_SECONDS    60       // Hold backspace to rewind this far
+#define REWIND_KEYFRAME   60       // Frames between full memory snapshots
+#define REPLAY_FILE       "build/replay.bin" // Input of the last game session
 
 // Ignore development package
 // #define RUNTIME
 
+// Record the last TRACE_RECORDS instructions into build/trace.bin, in debug
+// builds. A traced CPU never skips idle loops and runs its slow path.
+// #define MICRO16_TRACE
+
 #include "MiDi16/MicroDisplay16.hpp"
 #include "bob3000/Bob.hpp"
 #include "btp6000/Btp.hpp"
+#include "btp6000/Rewind.hpp"
 #include "pgu7000/Pgu.hpp"
+#include "replay/Replay.hpp"
 #include "cartlink/CartLink.hpp"
 
 // Main class
@@ -46,6 +56,9 @@ public:
         // CPU
         cpu.Reset();
         cpu.SetMemory( &memory );
+        #if defined( BTP_DEBUG ) && defined( MICRO16_TRACE )
+        cpu.SetTracer( &tracer );
+        #endif
 
         // Display
         window =
@@ -71,9 +84,15 @@ public:
         delete editor;
         #endif
 
+        if ( recording.IsStarted() )
+            recording.Save( REPLAY_FILE );
+
         #ifdef BTP_DEBUG
         cpu.DumpMemory( "build/memory.bin" );
         #endif
+        #if defined( BTP_DEBUG ) && defined( MICRO16_TRACE )
+        tracer.Dump( "build/trace.bin" );
+        #endif
     }
 
     // Update loop
@@ -88,6 +107,13 @@ public:
 private:
     Bob3k memory;
     btp::BetterThanPico cpu;
+    btp::RewindBuffer rewind{
+        REWIND_SECONDS * btp::FRAME_RATE, REWIND_KEYFRAME
+    };
+    replay::Recording recording;
+    #if defined( BTP_DEBUG ) && defined( MICRO16_TRACE )
+    btp::Tracer tracer{ TRACE_RECORDS };
+    #endif
     pgu::PixelGraphicsUnit *gpu;
 
     MiDi16::Window *window;
@@ -107,12 +133,24 @@ private:
 
 // Update loop
 void Micro16::Update() {
-    cpu.Execute();
+    if ( window->IsKeyDown( MiDi16::KEY_BACKSPACE ) ) {
+        if ( rewind.Rewind( cpu, memory ) )
+            recording.Rewind();
+        return;
+    }
+
+    MiDi16::Input input = window->GetInput();
+    replay::WriteInput( input, memory );
+    recording.Record( input );
+    cpu.RunFrame();
+    rewind.Push( cpu, memory );
 }
 
 // Draw loop
 void Micro16::Draw() {
-    gpu->RenderSprite( 0, 0, 10, 10 );
+    gpu->Latch();
+    gpu->Render();
+    memory.ClearDirty();
 }
 
 // Main loop
@@ -122,6 +160,8 @@ void Micro16::Run() {
         0xA0, 0x00, 0x02, 0xAC, 0xA0, 0xBE, 0xEF, 0x50, 0xC5, 0xFD,
     };
     memcpy( memory.data() + 0x2000, program, sizeof(program) );
+    memory.MarkDirty( 0x2000, sizeof(program) );
+    recording.Start( cpu, memory );
 
     while ( window->IsRunning() ) {
         window->PollEvents();
@@ -132,9 +172,12 @@ void Micro16::Run() {
         if ( window->IsKeyPressed( MiDi16::KEY_F5 ) ) {
             cpu.Reset();
             cpu.CS = 0x200; // Hardcode the code segment
+            rewind.Clear();
+            recording.Start( cpu, memory );
             state = GAME;
         }
         else if ( window->IsKeyPressed( MiDi16::KEY_ESC ) ) {
+            recording.Save( REPLAY_FILE );
             state = EDITOR;
         }
 
@@ -0,0 +1,223 @@
+/*
+* Copyright © 2025 Micro-16 Team
+* 
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the “Software”), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+* 
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+* 
+* THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+// Runs a cartridge, or replays a recorded session, on the CPU and PGU for a
+// number of frames without a window and reports how fast it went, along with a
+// hash of the final frame so that runs can be compared. Built with
+// MIDI16_HEADLESS, so it needs neither SDL nor a display.
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include "stdio.h"
+#include "stdint.h"
+#include "stdlib.h"
+#include "string.h"
+
+#define SCREEN_RESOLUTION 128
+#define DEFAULT_FRAMES    600
+#define PROFILE_ENTRIES   10 // Rows in each table of the profile
+#define REWIND_KEYFRAME   60 // Frames between full memory snapshots
+
+#include "btp6000/Rewind.hpp"
+#include "console/HeadlessConsole.hpp"
+
+const char helpMessage[] =
+"Micro-16 Headless Runner\n"
+"Arguments:\n"
+"    -h - Help message\n"
+"    -f - Number of frames to run (default: 600)\n"
+"    -p - Print a profile of where the cycles went\n"
+"    -r - Number of frames to rewind after running\n"
+"    -i - Replay a recording instead of running an object file\n"
+"    -o - Record the run to a file\n"
+"    default - Input object file\n"
+"\n\nExample:\n"
+"    Micro16-headless test.o -f 3600\n"
+"    Micro16-headless -i build/replay.bin\n";
+
+// FNV-1a hash of every pixel of a surface
+uint64_t HashSurface( const MiDi16::Surface &surface ) {
+    uint64_t hash = 0xCBF29CE484222325;
+    for ( int y = 0; y < surface.height(); y++ ) {
+        for ( int x = 0; x < surface.width(); x++ ) {
+            MiDi16::Color color = surface.Get( x, y );
+            const uint8_t channels[] = { color.r, color.g, color.b, color.a };
+            for ( uint8_t channel : channels ) {
+                hash ^= channel;
+                hash *= 0x100000001B3;
+            }
+        }
+    }
+    return hash;
+}
+
+int main( int argc, char **args ) {
+    std::string inputFile, replayFile, recordFile;
+    long frames = 0;
+    bool profile = false;
+    long rewindFrames = 0;
+    for ( int i = 1; i < argc; i++ ) {
+        std::string arg = args[i];
+        if ( arg == "-f" && i + 1 < argc )
+            frames = atol( args[++i] );
+        else if ( arg == "-p" )
+            profile = true;
+        else if ( arg == "-r" && i + 1 < argc )
+            rewindFrames = atol( args[++i] );
+        else if ( arg == "-i" && i + 1 < argc )
+            replayFile = args[++i];
+        else if ( arg == "-o" && i + 1 < argc )
+            recordFile = args[++i];
+        else if ( arg[0] == '-' ) {
+            std::cout << helpMessage;
+            return 1;
+        }
+        else
+            inputFile = arg;
+    }
+    if (
+        ( inputFile.empty() && replayFile.empty() ) ||
+        frames < 0 || rewindFrames < 0
+    ) {
+        std::cout << helpMessage;
+        return 1;
+    }
+
+    // With a recording the object file is only used for its labels
+    cart::Cartridge cartridge;
+    if ( !inputFile.empty() && !cartridge.Load( inputFile ) )
+        return 1;
+
+    // On the heap, since it holds the whole memory, and freed on every return
+    std::unique_ptr<micro16::HeadlessConsole> console(
+        new micro16::HeadlessConsole()
+    );
+    replay::Recording replay;
+    if ( !replayFile.empty() ) {
+        if ( !replay.Load( replayFile ) )
+            return 1;
+        if ( !replay.Restore( console->cpu, console->memory ) ) {
+            std::cout << "ERROR: \"" << replayFile << "\" has a save state "
+                "from another version!\n";
+            return 1;
+        }
+        if ( frames == 0 )
+            frames = replay.frames.size();
+    }
+    else
+        console->Insert( cartridge );
+    if ( frames == 0 )
+        frames = DEFAULT_FRAMES;
+
+    replay::Recording recording;
+    if ( !recordFile.empty() )
+        recording.Start( console->cpu, console->memory );
+
+    btp::Profiler profiler;
+    if ( profile ) {
+        for ( const cart::Label &label : cartridge.labels )
+            profiler.AddSymbol( label.name, label.address );
+        console->cpu.SetProfiler( &profiler );
+    }
+
+    // Only keep as many frames as will be rewound, plus a keyframe group since
+    // old frames are dropped a group at a time
+    btp::RewindBuffer rewind( rewindFrames + REWIND_KEYFRAME, REWIND_KEYFRAME );
+
+    uint64_t instructions = 0, cycles = 0;
+    auto start = std::chrono::steady_clock::now();
+    MiDi16::Input noInput;
+    for ( long frame = 0; frame < frames; frame++ ) {
+        // Frames past the end of the recording get no input
+        const MiDi16::Input &input = (size_t)frame < replay.frames.size() ?
+            replay.frames[frame] : noInput;
+        if ( !recordFile.empty() )
+            recording.Record( input );
+
+        btp::RunResult result = console->RunFrame( input );
+        instructions += result.instructions;
+        cycles += result.cycles;
+        if ( rewindFrames > 0 )
+            rewind.Push( console->cpu, console->memory );
+    }
+    double seconds = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start
+    ).count();
+
+    printf( "frames:         %ld\n", frames );
+    printf( "instructions:   %llu\n", (unsigned long long)instructions );
+    printf( "cycles:         %llu\n", (unsigned long long)cycles );
+    printf(
+        "idle skipped:   %llu cycles\n",
+        (unsigned long long)console->cpu.SkippedCycles()
+    );
+    printf( "seconds:        %.6f\n", seconds );
+    printf( "instructions/s: %.0f\n", instructions / seconds );
+    printf( "frames/s:       %.1f\n", frames / seconds );
+    printf(
+        "framebuffer:    %016llX\n",
+        (unsigned long long)HashSurface( console->screen )
+    );
+    if ( console->cpu.IsHalted() )
+        printf(
+            "halted:         %04X:%04X\n", console->cpu.CS, console->cpu.IP
+        );
+
+    if ( rewindFrames > 0 ) {
+        size_t size = rewind.Size();
+        long rewound = 0;
+        start = std::chrono::steady_clock::now();
+        while (
+            rewound < rewindFrames &&
+            rewind.Rewind( console->cpu, console->memory )
+        )
+            rewound++;
+        seconds = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - start
+        ).count();
+
+        printf( "rewound:        %ld frames\n", rewound );
+        printf( "rewind memory:  %zu bytes\n", size );
+        printf(
+            "us per rewind:  %.2f\n", rewound ? seconds * 1e6 / rewound : 0.0
+        );
+        printf(
+            "rewound to:     %04X:%04X\n", console->cpu.CS, console->cpu.IP
+        );
+    }
+
+    if ( !recordFile.empty() && !recording.Save( recordFile ) ) {
+        std::cout << "ERROR: Could not write \"" << recordFile << "\"!\n";
+        return 1;
+    }
+
+    if ( profile ) {
+        printf( "\n" );
+        profiler.Report( stdout, PROFILE_ENTRIES );
+    }
+
+    return 0;
+}
@@ -0,0 +1,243 @@
+/*
+* Copyright © 2025 Micro-16 Team
+* 
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the “Software”), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+* 
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+* 
+* THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+// Checks code translated by btp6kaot against the interpreter, then measures
+// how much faster it runs. Build it together with the translation of an
+// object and pass it the object (see the Makefile).
+//
+// The check runs a translated console and an interpreted console side by side
+// a frame at a time, with interrupts and the timer, and both the frames and
+// the consoles' registers and memories must match exactly. It runs again with
+// no watcher slot left for the translation, overwriting the translated code.
+
+#include <chrono>
+#include <string>
+
+#include "stdio.h"
+#include "stdint.h"
+#include "string.h"
+
+#include "btp6000/Aot.hpp"
+#include "btp6000/Btp.hpp"
+#include "cartridge/Cartridge.hpp"
+
+#define BENCH_SECONDS 2.0
+#define CHECK_FRAMES  600
+
+// A CPU with its own memory
+struct Console {
+    Bob3k memory;
+    btp::BetterThanPico cpu;
+
+    Console() {
+        cpu.Reset();
+        cpu.SetMemory( &memory );
+    }
+
+    // Loads a cartridge and points the CPU at its main label, like
+    // HeadlessConsole::Insert()
+    void Insert( const cart::Cartridge &cartridge ) {
+        memset( memory.data(), 0, BOB3K_SIZE );
+        cpu.Reset();
+        cartridge.Install( memory );
+
+        const cart::Label *main = cartridge.Find( "main" );
+        uint16_t entry = main != nullptr ? main->address : cartridge.origin;
+        cpu.CS = entry >> 4;
+        cpu.IP = entry & 0xF;
+    }
+};
+
+// Returns true if both consoles are in the same state
+bool SameState( Console &a, Console &b ) {
+    btp::BetterThanPico &x = a.cpu, &y = b.cpu;
+    return
+        x.A.value == y.A.value && x.B.value == y.B.value &&
+        x.X == y.X && x.Y == y.Y &&
+        x.IP == y.IP && x.SP == y.SP && x.BP == y.BP &&
+        x.SS == y.SS && x.CS == y.CS && x.DS == y.DS &&
+        x.GetFlags().value == y.GetFlags().value &&
+        x.IsHalted() == y.IsHalted() && x.IsWaiting() == y.IsWaiting() &&
+        memcmp( a.memory.data(), b.memory.data(), BOB3K_SIZE ) == 0;
+}
+
+// Runs both consoles a frame at a time until they halt or CHECK_FRAMES have
+// run, returns false on the first difference. `frames` is set to the frames
+// run.
+bool Check(
+    Console &interpreter,
+    Console &translated,
+    btp::Aot &aot,
+    int &frames
+) {
+    for ( frames = 0; frames < CHECK_FRAMES; ) {
+        btp::RunResult expected = interpreter.cpu.RunFrame();
+        btp::RunResult result = aot.RunFrame();
+        frames++;
+
+        if (
+            result.cycles != expected.cycles ||
+            result.instructions != expected.instructions ||
+            result.reason != expected.reason ||
+            !SameState( interpreter, translated )
+        ) {
+            printf(
+                "frame %d: %u cycles, %u instructions, reason %d, expected "
+                "%u, %u, %d\n",
+                frames, result.cycles, result.instructions, result.reason,
+                expected.cycles, expected.instructions, expected.reason
+            );
+            return false;
+        }
+        if ( expected.reason == btp::STOP_HALT )
+            break;
+    }
+    return true;
+}
+
+// Takes a watcher slot and ignores every write
+class Squatter : public Bob3kWatcher {
+public:
+    // Ignores the page
+    void PageWritten( uint8_t page ) override {}
+};
+
+// Translates with every watcher slot taken, runs a frame, then overwrites all
+// translated code with undefined opcodes. Returns false unless the consoles
+// still match frame for frame, which they only do if nothing was translated.
+bool CheckNoWatchers(
+    const cart::Cartridge &cartridge,
+    Console &interpreter,
+    Console &translated
+) {
+    interpreter.Insert( cartridge );
+    translated.Insert( cartridge );
+    Squatter squatters[BOB3K_WATCHER_MAX];
+    int slots[BOB3K_WATCHER_MAX];
+    for ( int i = 0; i < BOB3K_WATCHER_MAX; i++ )
+        slots[i] = translated.memory.AddWatcher( &squatters[i] );
+
+    int frames;
+    bool passed;
+    {
+        btp::Aot aot( &translated.cpu, btp::aotEntries, btp::aotEntryCount );
+        interpreter.cpu.RunFrame();
+        aot.RunFrame();
+        for ( int i = 0; i < btp::aotEntryCount; i++ ) {
+            const btp::AotEntry &entry = btp::aotEntries[i];
+            for (
+                int address = entry.first;
+                address <= entry.last;
+                address++
+            ) {
+                interpreter.memory.Write( address, 0xFF );
+                translated.memory.Write( address, 0xFF );
+            }
+        }
+        passed = Check( interpreter, translated, aot, frames );
+    }
+
+    for ( int slot : slots ) {
+        if ( slot != -1 )
+            translated.memory.RemoveWatcher( slot );
+    }
+    return passed;
+}
+
+// Runs frames for about BENCH_SECONDS, returns the MIPS
+double Bench( Console &console, btp::Aot *aot ) {
+    using Clock = std::chrono::steady_clock;
+
+    uint64_t instructions = 0;
+    double seconds = 0.0;
+    Clock::time_point start = Clock::now();
+
+    while ( seconds < BENCH_SECONDS ) {
+        for ( int i = 0; i < 100; i++ ) {
+            btp::RunResult result =
+                aot ? aot->RunFrame() : console.cpu.RunFrame();
+            instructions += result.instructions;
+        }
+
+        seconds =
+            std::chrono::duration<double>( Clock::now() - start ).count();
+    }
+
+    return instructions / seconds / 1e6;
+}
+
+int main( int argc, char **args ) {
+    if ( argc != 2 ) {
+        printf( "Usage: %s <object file>\n", args[0] );
+        return 1;
+    }
+
+    std::string name = args[1];
+    name = name.substr( name.find_last_of( '/' ) + 1 );
+    cart::Cartridge cartridge;
+    if ( !cartridge.Load( args[1] ) )
+        return 1;
+
+    // Differential check
+    static Console interpreter, translated;
+    interpreter.Insert( cartridge );
+    translated.Insert( cartridge );
+    int frames;
+    bool passed;
+    {
+        btp::Aot aot( &translated.cpu, btp::aotEntries, btp::aotEntryCount );
+        passed = Check( interpreter, translated, aot, frames );
+    }
+    printf(
+        "%s: differential check %s after %d frame%s%s\n",
+        name.c_str(), passed ? "passed" : "FAILED", frames,
+        frames == 1 ? "" : "s", interpreter.cpu.IsHalted() ? " (halted)" : ""
+    );
+    if ( !passed )
+        return 1;
+    bool halted = interpreter.cpu.IsHalted();
+
+    // Without a watcher slot the code is interpreted
+    if ( !CheckNoWatchers( cartridge, interpreter, translated ) ) {
+        printf(
+            "%s: translated code outlived being overwritten\n", name.c_str()
+        );
+        return 1;
+    }
+    if ( halted )
+        return 0;
+
+    // Speed, on code that runs for good and without skipping idle loops
+    interpreter.Insert( cartridge );
+    translated.Insert( cartridge );
+    interpreter.cpu.SetIdleSkipping( false );
+    translated.cpu.SetIdleSkipping( false );
+    btp::Aot aot( &translated.cpu, btp::aotEntries, btp::aotEntryCount );
+    double interpreted = Bench( interpreter, nullptr );
+    double native = Bench( translated, &aot );
+    printf(
+        "%s: interpreter %8.2f MIPS  translated %8.2f MIPS  (%.1fx)\n",
+        name.c_str(), interpreted, native, native / interpreted
+    );
+
+    return 0;
+}
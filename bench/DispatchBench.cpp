@@ -0,0 +1,85 @@
+/*
+* Copyright © 2025 Micro-16 Team
+* 
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the “Software”), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+* 
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+* 
+* THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+// Measures how fast the CPU core runs the example programs. Build it with and
+// without BTP_THREADED to compare the switch and threaded dispatch cores (see
+// the Makefile).
+
+#include <chrono>
+#include <iostream>
+
+#include "stdio.h"
+#include "stdint.h"
+#include "string.h"
+
+#include "btp6000/Btp.hpp"
+
+#include "Programs.hpp"
+
+#ifdef BTP_THREADED
+#define CORE_NAME "threaded"
+#else
+#define CORE_NAME "switch"
+#endif
+
+#define BENCH_SECONDS 2.0
+
+// Runs a program for about BENCH_SECONDS and prints its speed
+void Bench( const Program &program, Bob3k &memory, btp::BetterThanPico &cpu ) {
+    using Clock = std::chrono::steady_clock;
+
+    uint64_t instructions = 0, cycles = 0;
+    double seconds = 0.0;
+
+    LoadProgram( program, memory, cpu );
+    Clock::time_point start = Clock::now();
+
+    while ( seconds < BENCH_SECONDS ) {
+        btp::RunResult result = cpu.RunCycles( btp::CYCLES_PER_FRAME );
+        instructions += result.instructions;
+        cycles += result.cycles;
+
+        // Start over once the program halts
+        if ( result.reason == btp::STOP_HALT )
+            LoadProgram( program, memory, cpu );
+
+        seconds =
+            std::chrono::duration<double>( Clock::now() - start ).count();
+    }
+
+    printf(
+        "%-8s %-10s %8.2f MIPS %8.2f MHz\n",
+        CORE_NAME, program.name,
+        instructions / seconds / 1e6, cycles / seconds / 1e6
+    );
+}
+
+int main() {
+    static Bob3k memory;
+    btp::BetterThanPico cpu;
+    cpu.SetMemory( &memory );
+
+    for ( const Program &program : programs )
+        Bench( program, memory, cpu );
+
+    return 0;
+}
@@ -0,0 +1,246 @@
+/*
+* Copyright © 2025 Micro-16 Team
+* 
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the “Software”), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+* 
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+* 
+* THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+// Checks that fast-forwarding idle loops leaves every frame exactly as running
+// them would, then measures how much host time it saves and how many cycles
+// it skips.
+
+#include <chrono>
+
+#include "stdio.h"
+#include "stdint.h"
+#include "string.h"
+
+#include "btp6000/Btp.hpp"
+
+#include "Programs.hpp"
+
+#define BENCH_SECONDS 1.0
+#define CHECK_FRAMES  600
+#define IDLE_ORIGIN   0x1000
+#define TOGGLE_TABLE  0x0100 // In the stack segment, where pointers lead
+#define SWEEP_FRAMES  3
+
+// Spins on itself between interrupts
+const uint8_t spinCode[] = {
+    0xC5, 0xFE, // main: jmp main
+    0x00,       // (padding)
+    0x01,       // handler: rti
+};
+
+// Polls a word that the vblank handler stores to
+const uint8_t pollCode[] = {
+    0xB3, 0x08,       // main: ldb [8]
+    0xC5, 0xFC,       // jmp main
+    0xA0, 0x01, 0x00, // handler: lda 1
+    0xA7,             // sta [x]
+    0x01,             // rti
+};
+
+// Polls a word that the handlers switch between 2 and 4 through a table,
+// keeping A so that only the polled value tells the iterations apart
+const uint8_t togglePollCode[] = {
+    0xB3, 0x08, // main: ldb [8]
+    0xC5, 0xFC, // jmp main
+    0x50,       // handler: pusha
+    0xA4,       // lda [[x]+y]
+    0xA7,       // sta [x]
+    0x51,       // popa
+    0x01,       // rti
+};
+
+// Loops without writing, but never comes back to the same state
+const uint8_t popCode[] = {
+    0x53,       // main: popb
+    0xC5, 0xFD, // jmp main
+};
+
+// A program and the interrupts it handles
+struct IdleProgram {
+    const char *name;
+    const uint8_t *code;
+    size_t size;
+    uint8_t handler;     // Offset of the handler, 0 for no interrupts
+    uint16_t period;     // Timer period, 0 for no timer
+};
+
+const IdleProgram idlePrograms[] = {
+    { "spin",         spinCode, sizeof( spinCode ), 3, 0 },
+    { "spin + timer", spinCode, sizeof( spinCode ), 3, 1000 },
+    { "poll + timer", pollCode, sizeof( pollCode ), 4, 700 },
+    { "toggle + timer", togglePollCode, sizeof( togglePollCode ), 4, 358 },
+    { "pop",          popCode,  sizeof( popCode ),  0, 0 },
+};
+
+// Loads a program, points the vblank and timer vectors at its handler and
+// starts the timer
+void Load(
+    const IdleProgram &program,
+    bool skipping,
+    Bob3k &memory,
+    btp::BetterThanPico &cpu
+) {
+    memset( memory.data(), 0, BOB3K_SIZE );
+    memcpy( memory.data() + IDLE_ORIGIN, program.code, program.size );
+
+    if ( program.handler != 0 ) {
+        for ( int vector : { btp::IRQ_VBLANK, btp::IRQ_TIMER } ) {
+            uint16_t entry = btp::InterruptEntry( vector );
+            memory.Write16( entry, IDLE_ORIGIN >> 4 );
+            memory.Write16( entry + 2, program.handler );
+        }
+    }
+    memory.Write16( btp::TIMER_PERIOD, program.period );
+
+    cpu.Reset();
+    cpu.CS = IDLE_ORIGIN >> 4;
+    cpu.SS = 0x200;
+    cpu.X = 8;
+    cpu.Y = TOGGLE_TABLE;
+
+    // Next value of the toggled word, by its current one
+    uint16_t table = ( cpu.SS << 4 ) + TOGGLE_TABLE;
+    memory.Write16( table, 2 );
+    memory.Write16( table + 2, 4 );
+    memory.Write16( table + 4, 2 );
+    cpu.SetIdleSkipping( skipping );
+}
+
+// Runs the same program with and without skipping and returns false unless
+// every frame ends the same
+bool Check(
+    const char *name,
+    Bob3k &memory,
+    btp::BetterThanPico &cpu,
+    Bob3k &skipMemory,
+    btp::BetterThanPico &skipCpu,
+    int frames = CHECK_FRAMES
+) {
+    for ( int frame = 0; frame < frames; frame++ ) {
+        btp::RunResult run = cpu.RunFrame();
+        btp::RunResult skip = skipCpu.RunFrame();
+        btp::CpuState runState = cpu.GetState();
+        btp::CpuState skipState = skipCpu.GetState();
+
+        if (
+            run.cycles != skip.cycles ||
+            run.instructions != skip.instructions ||
+            run.reason != skip.reason ||
+            memcmp( &runState, &skipState, sizeof( btp::CpuState ) ) ||
+            memcmp( memory.data(), skipMemory.data(), BOB3K_SIZE )
+        ) {
+            printf( "%s: frame %d differs when skipping\n", name, frame );
+            return false;
+        }
+    }
+    return true;
+}
+
+// Runs frames for about BENCH_SECONDS, returns the frames per second
+double Bench( btp::BetterThanPico &cpu ) {
+    using Clock = std::chrono::steady_clock;
+
+    uint64_t frames = 0;
+    double seconds = 0.0;
+    Clock::time_point start = Clock::now();
+    while ( seconds < BENCH_SECONDS ) {
+        for ( int i = 0; i < 100; i++ )
+            cpu.RunFrame();
+        frames += 100;
+
+        seconds =
+            std::chrono::duration<double>( Clock::now() - start ).count();
+    }
+
+    return frames / seconds;
+}
+
+// Times a loaded program with skipping off and on and prints a row
+void Report(
+    const char *name,
+    btp::BetterThanPico &cpu,
+    btp::BetterThanPico &skipCpu
+) {
+    uint64_t before = skipCpu.SkippedCycles();
+    double run = Bench( cpu );
+    double skip = Bench( skipCpu );
+
+    // Every frame runs CYCLES_PER_FRAME give or take an overshoot
+    double frames = skip * BENCH_SECONDS;
+    double skipped = ( skipCpu.SkippedCycles() - before ) /
+        ( frames * btp::CYCLES_PER_FRAME );
+    printf(
+        "%-14s  run %9.0f fps  skip %9.0f fps  (%6.1fx)  %5.1f%% skipped\n",
+        name, run, skip, skip / run, std::min( skipped, 1.0 ) * 100
+    );
+}
+
+int main() {
+    static Bob3k memory, skipMemory;
+    btp::BetterThanPico cpu, skipCpu;
+    cpu.SetMemory( &memory );
+    skipCpu.SetMemory( &skipMemory );
+
+    bool passed = true;
+    for ( const IdleProgram &program : idlePrograms ) {
+        Load( program, false, memory, cpu );
+        Load( program, true, skipMemory, skipCpu );
+        passed = passed &&
+            Check( program.name, memory, cpu, skipMemory, skipCpu );
+    }
+    for ( const Program &program : programs ) {
+        LoadProgram( program, memory, cpu );
+        LoadProgram( program, skipMemory, skipCpu );
+        skipCpu.SetIdleSkipping( true );
+        passed = passed &&
+            Check( program.name, memory, cpu, skipMemory, skipCpu );
+    }
+
+    // The timer lands at every point of the polling loop for some period
+    IdleProgram sweep = idlePrograms[3];
+    for ( int period = 50; passed && period < 400; period++ ) {
+        char name[32];
+        snprintf( name, sizeof( name ), "toggle period %d", period );
+        sweep.period = period;
+        Load( sweep, false, memory, cpu );
+        Load( sweep, true, skipMemory, skipCpu );
+        passed = Check( name, memory, cpu, skipMemory, skipCpu, SWEEP_FRAMES );
+    }
+    printf( "Idle check: %s\n", passed ? "passed" : "FAILED" );
+    if ( !passed )
+        return 1;
+
+    for ( const IdleProgram &program : idlePrograms ) {
+        Load( program, false, memory, cpu );
+        Load( program, true, skipMemory, skipCpu );
+        Report( program.name, cpu, skipCpu );
+    }
+    for ( const Program &program : programs ) {
+        LoadProgram( program, memory, cpu );
+        LoadProgram( program, skipMemory, skipCpu );
+        skipCpu.SetIdleSkipping( true );
+        Report( program.name, cpu, skipCpu );
+    }
+
+    return 0;
+}
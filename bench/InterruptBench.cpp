@@ -0,0 +1,218 @@
+/*
+* Copyright © 2025 Micro-16 Team
+* 
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the “Software”), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+* 
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+* 
+* THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+// Checks that the vblank and timer interrupts arrive when they should and
+// that INT halts on a vector that is not installed, then
+// measures how much faster a program that waits for its interrupts with WAI
+// runs than one that spins in a loop between them.
+
+#include <chrono>
+
+#include "stdio.h"
+#include "stdint.h"
+#include "string.h"
+
+#include "btp6000/Btp.hpp"
+
+#define BENCH_SECONDS 2.0
+#define CHECK_FRAMES  600
+#define IDLE_ORIGIN   0x1000
+#define TIMER_CYCLES  100
+
+// Waits for interrupts whose handlers return straight away
+const uint8_t idleCode[] = {
+    0x02,       // main: wai
+    0xC5, 0xFD, // jmp main
+    0x01,       // handler: rti
+};
+
+// Spins between the same interrupts
+const uint8_t busyCode[] = {
+    0xC5, 0xFE, // main: jmp main
+    0x00,       // (padding)
+    0x01,       // handler: rti
+};
+
+// Enters vector 5 once, then waits
+const uint8_t intCode[] = {
+    0x00, 0x05, // main: int 5
+    0x02,       // wai
+    0x01,       // handler: rti
+};
+
+// Offset of the handler in all programs
+#define HANDLER_OFFSET 3
+#define INT_VECTOR     5
+
+// Loads a program, points the vectors in `vectors` (bit per vector) at its
+// handler and starts the timer if `period` is not 0
+void Load(
+    const uint8_t *code,
+    size_t size,
+    uint16_t vectors,
+    uint16_t period,
+    Bob3k &memory,
+    btp::BetterThanPico &cpu
+) {
+    memset( memory.data(), 0, BOB3K_SIZE );
+    memcpy( memory.data() + IDLE_ORIGIN, code, size );
+
+    for ( int vector = 0; vector < btp::INTERRUPT_COUNT; vector++ ) {
+        if ( vectors & ( 1 << vector ) ) {
+            uint16_t entry = btp::InterruptEntry( vector );
+            memory.Write16( entry, IDLE_ORIGIN >> 4 );
+            memory.Write16( entry + 2, HANDLER_OFFSET );
+        }
+    }
+    memory.Write16( btp::TIMER_PERIOD, period );
+
+    cpu.Reset();
+    cpu.CS = IDLE_ORIGIN >> 4;
+    cpu.SS = 0x200;
+
+    // Compare WAI with actually spinning
+    cpu.SetIdleSkipping( false );
+}
+
+// Runs the idle program with some interrupts and returns false unless every
+// frame ran `events` handlers, give or take one over all frames
+bool Check(
+    const char *name,
+    uint16_t vectors,
+    uint16_t period,
+    double events,
+    Bob3k &memory,
+    btp::BetterThanPico &cpu
+) {
+    Load( idleCode, sizeof( idleCode ), vectors, period, memory, cpu );
+
+    // Every handler ends with the program's only rti
+    btp::Profiler profiler;
+    cpu.SetProfiler( &profiler );
+    for ( int frame = 0; frame < CHECK_FRAMES; frame++ ) {
+        btp::RunResult result = cpu.RunFrame();
+        if ( result.reason != btp::STOP_BUDGET ) {
+            printf( "%s: stopped with reason %d\n", name, result.reason );
+            return false;
+        }
+    }
+    cpu.SetProfiler( nullptr );
+
+    uint64_t handled = profiler.OpcodeCount( btp::INS_RTI );
+    double expected = events * CHECK_FRAMES;
+    if ( handled + 1 < expected || handled > expected + 1 ) {
+        printf(
+            "%s: %llu interrupts, expected %.0f\n",
+            name, (unsigned long long)handled, expected
+        );
+        return false;
+    }
+    return true;
+}
+
+// Returns false unless INT enters the handler of an installed vector, and
+// halts on the INT without pushing anything if the vector is not installed
+bool CheckSoftware( Bob3k &memory, btp::BetterThanPico &cpu ) {
+    Load( intCode, sizeof( intCode ), 1 << INT_VECTOR, 0, memory, cpu );
+    btp::Profiler profiler;
+    cpu.SetProfiler( &profiler );
+    btp::RunResult result = cpu.RunFrame();
+    cpu.SetProfiler( nullptr );
+    if (
+        result.reason == btp::STOP_HALT ||
+        profiler.OpcodeCount( btp::INS_RTI ) != 1
+    ) {
+        printf( "int: the installed vector was not entered\n" );
+        return false;
+    }
+
+    Load( intCode, sizeof( intCode ), 0, 0, memory, cpu );
+    uint16_t sp = cpu.SP;
+    result = cpu.RunFrame();
+    if (
+        result.reason != btp::STOP_HALT || result.instructions != 1 ||
+        cpu.IP != 0 || cpu.SP != sp
+    ) {
+        printf(
+            "int: ran %u instructions through an empty vector\n",
+            result.instructions
+        );
+        return false;
+    }
+    return true;
+}
+
+// Runs a program for about BENCH_SECONDS, returns the frames per second
+double Bench(
+    const uint8_t *code,
+    size_t size,
+    Bob3k &memory,
+    btp::BetterThanPico &cpu
+) {
+    using Clock = std::chrono::steady_clock;
+
+    Load( code, size, 0b11, TIMER_CYCLES, memory, cpu );
+
+    uint64_t frames = 0;
+    double seconds = 0.0;
+    Clock::time_point start = Clock::now();
+    while ( seconds < BENCH_SECONDS ) {
+        for ( int i = 0; i < 100; i++ )
+            cpu.RunFrame();
+        frames += 100;
+
+        seconds =
+            std::chrono::duration<double>( Clock::now() - start ).count();
+    }
+
+    return frames / seconds;
+}
+
+int main() {
+    static Bob3k memory;
+    btp::BetterThanPico cpu;
+    cpu.SetMemory( &memory );
+
+    double timerEvents = (double)btp::CYCLES_PER_FRAME / TIMER_CYCLES;
+    bool passed =
+        Check( "vblank", 0b01, 0, 1, memory, cpu ) &&
+        Check( "timer", 0b10, TIMER_CYCLES, timerEvents, memory, cpu ) &&
+        Check(
+            "vblank and timer", 0b11, TIMER_CYCLES, timerEvents + 1,
+            memory, cpu
+        ) &&
+        Check( "nothing installed", 0, TIMER_CYCLES, 0, memory, cpu ) &&
+        CheckSoftware( memory, cpu );
+    printf( "Interrupt check: %s\n", passed ? "passed" : "FAILED" );
+    if ( !passed )
+        return 1;
+
+    double idle = Bench( idleCode, sizeof( idleCode ), memory, cpu );
+    double busy = Bench( busyCode, sizeof( busyCode ), memory, cpu );
+    printf(
+        "timer every %d cycles  spinning %9.0f fps  wai %9.0f fps  (%.1fx)\n",
+        TIMER_CYCLES, busy, idle, idle / busy
+    );
+
+    return 0;
+}
@@ -0,0 +1,204 @@
+/*
+* Copyright © 2025 Micro-16 Team
+* 
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the “Software”), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+* 
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+* 
+* THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+// Checks the x86-64 recompiler against the interpreter, then measures how
+// much faster it runs the example programs.
+//
+// The check runs a JIT console and an interpreter console side by side: after
+// every batch of JIT cycles, the interpreter executes the same number of
+// instructions and both register files and memories must match exactly.
+
+#include <chrono>
+#include <iostream>
+#include <random>
+
+#include "stdio.h"
+#include "stdint.h"
+#include "string.h"
+
+#include "btp6000/Btp.hpp"
+#include "btp6000/Jit.hpp"
+
+#include "Programs.hpp"
+
+#define BENCH_SECONDS      2.0
+#define CHECK_INSTRUCTIONS 1000000
+#define CHECK_SEEDS        100
+
+// A CPU with its own memory
+struct Console {
+    Bob3k memory;
+    btp::BetterThanPico cpu;
+
+    Console() {
+        cpu.Reset();
+        cpu.SetMemory( &memory );
+    }
+};
+
+// Returns true if both consoles are in the same state
+bool SameState( Console &a, Console &b ) {
+    btp::BetterThanPico &x = a.cpu, &y = b.cpu;
+    return
+        x.A.value == y.A.value && x.B.value == y.B.value &&
+        x.X == y.X && x.Y == y.Y &&
+        x.IP == y.IP && x.SP == y.SP && x.BP == y.BP &&
+        x.SS == y.SS && x.CS == y.CS && x.DS == y.DS &&
+        x.GetFlags().value == y.GetFlags().value &&
+        x.IsHalted() == y.IsHalted() &&
+        memcmp( a.memory.data(), b.memory.data(), BOB3K_SIZE ) == 0;
+}
+
+// Runs the JIT console in random sized batches and the interpreter console in
+// lockstep, returns false on the first difference
+bool Check( Console &interpreter, Console &recompiled, std::mt19937 &rng ) {
+    btp::Jit jit( &recompiled.cpu );
+    uint64_t instructions = 0;
+
+    while ( instructions < CHECK_INSTRUCTIONS ) {
+        btp::RunResult result = jit.RunCycles( rng() % 256 );
+
+        uint32_t cycles = 0;
+        for ( uint32_t i = 0; i < result.instructions; i++ )
+            cycles += interpreter.cpu.Execute();
+
+        if ( cycles != result.cycles || !SameState( interpreter, recompiled ) )
+            return false;
+        if (
+            result.reason == btp::STOP_HALT || result.reason == btp::STOP_WAIT
+        )
+            break;
+
+        instructions += result.instructions + 1;
+    }
+
+    return true;
+}
+
+// Fills memory with mostly translatable opcodes and random segments
+void LoadRandom( Console &console, std::mt19937 &rng ) {
+    const uint8_t opcodes[] = {
+        0xA0, 0xA1, 0xA2, 0xA3, 0xA4, 0xA5, 0xA6, 0xA7, 0xA8, 0xA9, 0xAA,
+        0xAB, 0xAC, 0xAE, 0xB0, 0xB1, 0xB2, 0xB3, 0xB4, 0xB5, 0xB6, 0xB7,
+        0xB8, 0xB9, 0xBA, 0xBB, 0xBC, 0xBE, 0x80, 0x81, 0x82, 0x83, 0x84,
+        0x85, 0x86, 0x87, 0x88, 0x89, 0x8A, 0x8B, 0x8C, 0x8E, 0x90, 0x91,
+        0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9A, 0x9B, 0x9C,
+        0x9E, 0x50, 0x51, 0x52, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59,
+        0xC5, 0xC5, 0xC5, 0xAD, 0xBD, 0x8D, 0x9D,
+    };
+
+    for ( int i = 0; i < BOB3K_SIZE; i++ ) {
+        console.memory.data()[i] = rng() % 40
+            ? opcodes[rng() % sizeof( opcodes )]
+            : rng();
+    }
+
+    btp::BetterThanPico &cpu = console.cpu;
+    cpu.Reset();
+    cpu.CS = rng();
+    cpu.SS = rng();
+    cpu.DS = rng();
+    cpu.SP = rng();
+    cpu.BP = rng();
+}
+
+// Copies the whole state of one console into another
+void CopyConsole( Console &from, Console &to ) {
+    memcpy( to.memory.data(), from.memory.data(), BOB3K_SIZE );
+
+    btp::BetterThanPico &x = from.cpu, &y = to.cpu;
+    y.Reset();
+    y.A = x.A; y.B = x.B; y.X = x.X; y.Y = x.Y;
+    y.IP = x.IP; y.SP = x.SP; y.BP = x.BP;
+    y.SS = x.SS; y.CS = x.CS; y.DS = x.DS;
+    y.SetFlags( x.GetFlags() );
+}
+
+// Runs a program for about BENCH_SECONDS, returns the MIPS
+double Bench( const Program &program, Console &console, btp::Jit *jit ) {
+    using Clock = std::chrono::steady_clock;
+
+    uint64_t instructions = 0;
+    double seconds = 0.0;
+
+    LoadProgram( program, console.memory, console.cpu );
+    Clock::time_point start = Clock::now();
+
+    while ( seconds < BENCH_SECONDS ) {
+        btp::RunResult result = jit
+            ? jit->RunCycles( btp::CYCLES_PER_FRAME )
+            : console.cpu.RunCycles( btp::CYCLES_PER_FRAME );
+        instructions += result.instructions;
+
+        // Start over once the program halts
+        if ( result.reason == btp::STOP_HALT ) {
+            LoadProgram( program, console.memory, console.cpu );
+            if ( jit )
+                jit->Flush();
+        }
+
+        seconds =
+            std::chrono::duration<double>( Clock::now() - start ).count();
+    }
+
+    return instructions / seconds / 1e6;
+}
+
+int main() {
+    static Console interpreter, recompiled;
+    std::mt19937 rng( 6000 );
+    bool passed = true;
+
+    // Differential check
+    for ( const Program &program : programs ) {
+        LoadProgram( program, interpreter.memory, interpreter.cpu );
+        CopyConsole( interpreter, recompiled );
+        if ( !Check( interpreter, recompiled, rng ) ) {
+            printf( "FAIL %s\n", program.name );
+            passed = false;
+        }
+    }
+    for ( int seed = 0; seed < CHECK_SEEDS; seed++ ) {
+        LoadRandom( interpreter, rng );
+        CopyConsole( interpreter, recompiled );
+        if ( !Check( interpreter, recompiled, rng ) ) {
+            printf( "FAIL random program %d\n", seed );
+            passed = false;
+        }
+    }
+    printf( "Differential check: %s\n", passed ? "passed" : "FAILED" );
+    if ( !passed )
+        return 1;
+
+    // Speed
+    btp::Jit jit( &recompiled.cpu );
+    for ( const Program &program : programs ) {
+        double interpreted = Bench( program, interpreter, nullptr );
+        double jitted = Bench( program, recompiled, &jit );
+        printf(
+            "%-10s interpreter %8.2f MIPS  jit %8.2f MIPS  (%.1fx)\n",
+            program.name, interpreted, jitted, jitted / interpreted
+        );
+    }
+
+    return 0;
+}
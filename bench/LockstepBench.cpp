@@ -0,0 +1,258 @@
+/*
+* Copyright © 2025 Micro-16 Team
+* 
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the “Software”), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+* 
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+* 
+* THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+// Checks the lockstep interpreter against the scalar core, then measures how
+// much faster it runs many copies of the example programs.
+//
+// The check runs every lane of a Lockstep next to a scalar console started in
+// the same state. Lanes are mostly copies of one program, but some get a few
+// bytes of memory or a register changed so that they leave their group on the
+// way. After every frame the results, registers and memories must match.
+
+#include <chrono>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "stdio.h"
+#include "stdint.h"
+#include "string.h"
+
+#include "btp6000/Btp.hpp"
+#include "btp6000/Lockstep.hpp"
+
+#include "Programs.hpp"
+
+#define CHECK_LANES  40 // Two full groups and a partial one
+#define CHECK_FRAMES 10
+#define CHECK_SEEDS  50
+#define BENCH_LANES  1024
+#define BENCH_FRAMES 20
+
+// A CPU with its own memory
+struct Console {
+    Bob3k memory;
+    btp::BetterThanPico cpu;
+
+    Console() {
+        memset( memory.data(), 0, BOB3K_SIZE );
+        cpu.Reset();
+        cpu.SetMemory( &memory );
+    }
+};
+
+// Returns true if a lane and a console are in the same state
+bool SameState(
+    btp::Lockstep &lockstep,
+    uint32_t lane,
+    Console &console,
+    const btp::RunResult &result
+) {
+    btp::CpuState a = lockstep.Cpu( lane ).GetState();
+    btp::CpuState b = console.cpu.GetState();
+    const btp::RunResult &laneResult = lockstep.Results()[lane];
+    return
+        memcmp( &a, &b, sizeof( a ) ) == 0 &&
+        laneResult.cycles == result.cycles &&
+        laneResult.instructions == result.instructions &&
+        laneResult.reason == result.reason &&
+        memcmp(
+            lockstep.Memory( lane ).data(), console.memory.data(), BOB3K_SIZE
+        ) == 0;
+}
+
+// Fills memory with mostly valid opcodes and random segments
+void LoadRandom( Bob3k &memory, btp::BetterThanPico &cpu, std::mt19937 &rng ) {
+    const uint8_t opcodes[] = {
+        0xA0, 0xA1, 0xA2, 0xA3, 0xA4, 0xA5, 0xA6, 0xA7, 0xA8, 0xA9, 0xAA,
+        0xAB, 0xAC, 0xAE, 0xB0, 0xB1, 0xB2, 0xB3, 0xB4, 0xB5, 0xB6, 0xB7,
+        0xB8, 0xB9, 0xBA, 0xBB, 0xBC, 0xBE, 0x80, 0x81, 0x82, 0x83, 0x84,
+        0x85, 0x86, 0x87, 0x88, 0x89, 0x8A, 0x8B, 0x8C, 0x8E, 0x90, 0x91,
+        0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9A, 0x9B, 0x9C,
+        0x9E, 0x50, 0x51, 0x52, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59,
+        0xC5, 0xC5, 0xC5, 0xAD, 0xBD, 0x8D, 0x9D, 0x00, 0x01, 0x02,
+    };
+
+    for ( int i = 0; i < BOB3K_SIZE; i++ ) {
+        memory.data()[i] = rng() % 40
+            ? opcodes[rng() % sizeof( opcodes )]
+            : rng();
+    }
+
+    // Only the vblank and timer vectors are installed
+    uint8_t *table = memory.data() + btp::INTERRUPT_TABLE;
+    memset( table, 0, btp::TIMER_PERIOD + 2 - btp::INTERRUPT_TABLE );
+    for ( uint8_t vector : { btp::IRQ_VBLANK, btp::IRQ_TIMER } ) {
+        uint16_t entry[2] = { (uint16_t)rng(), (uint16_t)rng() };
+        memcpy( table + vector * 4, entry, sizeof( entry ) );
+    }
+    uint16_t period = 2000 + rng() % 8000;
+    memcpy( memory.data() + btp::TIMER_PERIOD, &period, sizeof( period ) );
+
+    cpu.Reset();
+    cpu.CS = rng();
+    cpu.SS = rng();
+    cpu.DS = rng();
+    cpu.SP = rng();
+    cpu.BP = rng();
+}
+
+// Copies a CPU and memory into a lane and a console
+void Copy(
+    const Bob3k &memory,
+    btp::BetterThanPico &cpu,
+    btp::Lockstep &lockstep,
+    uint32_t lane,
+    Console &console
+) {
+    btp::CpuState state = cpu.GetState();
+    memcpy( lockstep.Memory( lane ).data(), memory.data(), BOB3K_SIZE );
+    memcpy( console.memory.data(), memory.data(), BOB3K_SIZE );
+    lockstep.Cpu( lane ).Reset();
+    lockstep.Cpu( lane ).SetState( state );
+    console.cpu.Reset();
+    console.cpu.SetState( state );
+}
+
+// Runs the lanes and consoles for CHECK_FRAMES frames, returns false on the
+// first difference
+bool Check( btp::Lockstep &lockstep, std::vector<Console> &consoles ) {
+    for ( int frame = 0; frame < CHECK_FRAMES; frame++ ) {
+        lockstep.RunFrame();
+        for ( uint32_t lane = 0; lane < lockstep.Count(); lane++ ) {
+            btp::RunResult result = consoles[lane].cpu.RunFrame();
+            if ( !SameState( lockstep, lane, consoles[lane], result ) ) {
+                printf( "lane %u differs after frame %d\n", lane, frame );
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Runs BENCH_FRAMES frames of a program on BENCH_LANES lanes, returns the
+// MIPS over all lanes
+double Bench( const Program &program, bool lockstep ) {
+    using Clock = std::chrono::steady_clock;
+
+    btp::Lockstep lanes( BENCH_LANES );
+    std::unique_ptr<Console[]> consoles;
+    if ( !lockstep )
+        consoles.reset( new Console[BENCH_LANES] );
+    for ( uint32_t i = 0; i < BENCH_LANES; i++ ) {
+        if ( lockstep )
+            LoadProgram( program, lanes.Memory( i ), lanes.Cpu( i ) );
+        else
+            LoadProgram( program, consoles[i].memory, consoles[i].cpu );
+    }
+
+    uint64_t instructions = 0;
+    Clock::time_point start = Clock::now();
+    for ( int frame = 0; frame < BENCH_FRAMES; frame++ ) {
+        if ( lockstep ) {
+            lanes.RunFrame();
+            for ( uint32_t i = 0; i < BENCH_LANES; i++ )
+                instructions += lanes.Results()[i].instructions;
+        }
+        else {
+            for ( uint32_t i = 0; i < BENCH_LANES; i++ )
+                instructions += consoles[i].cpu.RunFrame().instructions;
+        }
+    }
+    double seconds =
+        std::chrono::duration<double>( Clock::now() - start ).count();
+
+    return instructions / seconds / 1e6;
+}
+
+int main() {
+    std::mt19937 rng( 6000 );
+    static Console source;
+    bool passed = true;
+
+    // Differential check
+    for ( const Program &program : programs ) {
+        btp::Lockstep lockstep( CHECK_LANES );
+        std::vector<Console> consoles( CHECK_LANES );
+        LoadProgram( program, source.memory, source.cpu );
+        for ( uint32_t lane = 0; lane < CHECK_LANES; lane++ )
+            Copy( source.memory, source.cpu, lockstep, lane, consoles[lane] );
+
+        if ( !Check( lockstep, consoles ) ) {
+            printf( "FAIL %s\n", program.name );
+            passed = false;
+        }
+    }
+    uint64_t inLockstep = 0, total = 0;
+    for ( int seed = 0; seed < CHECK_SEEDS; seed++ ) {
+        btp::Lockstep lockstep( CHECK_LANES );
+        std::vector<Console> consoles( CHECK_LANES );
+        LoadRandom( source.memory, source.cpu, rng );
+        for ( uint32_t lane = 0; lane < CHECK_LANES; lane++ ) {
+            Copy( source.memory, source.cpu, lockstep, lane, consoles[lane] );
+
+            // Some lanes get different data or code
+            if ( lane % 3 == 1 ) {
+                for ( int i = 0; i < 16; i++ ) {
+                    uint16_t address = rng();
+                    uint8_t value = rng();
+                    lockstep.Memory( lane ).data()[address] = value;
+                    consoles[lane].memory.data()[address] = value;
+                }
+            }
+            if ( lane % 5 == 2 ) {
+                uint16_t value = rng();
+                lockstep.Cpu( lane ).A.value = value;
+                consoles[lane].cpu.A.value = value;
+            }
+        }
+
+        if ( !Check( lockstep, consoles ) ) {
+            printf( "FAIL random program %d\n", seed );
+            passed = false;
+        }
+        inLockstep += lockstep.LockstepInstructions();
+        total +=
+            lockstep.LockstepInstructions() + lockstep.ScalarInstructions();
+    }
+    printf(
+        "Differential check: %s (%s, %.0f%% of random code in lockstep)\n",
+        passed ? "passed" : "FAILED",
+        btp::Lockstep::IsVectorized() ? "AVX2" : "scalar only",
+        total ? 100.0 * inLockstep / total : 0.0
+    );
+    if ( !passed )
+        return 1;
+
+    // Speed
+    for ( const Program &program : programs ) {
+        double scalar = Bench( program, false );
+        double lockstep = Bench( program, true );
+        printf(
+            "%-10s %u lanes  scalar %8.2f MIPS  lockstep %8.2f MIPS  (%.1fx)\n",
+            program.name, BENCH_LANES, scalar, lockstep, lockstep / scalar
+        );
+    }
+
+    return 0;
+}
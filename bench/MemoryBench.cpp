@@ -0,0 +1,352 @@
+/*
+* Copyright © 2025 Micro-16 Team
+* 
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the “Software”), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+* 
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+* 
+* THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+// Checks that the memory bus routes reads and writes of RAM, read-only and
+// device pages where they belong and marks the right blocks dirty, that
+// decoded and translated code follows remapped pages and device reads, then
+// measures what each kind of page costs.
+
+#include <chrono>
+
+#include "stdio.h"
+#include "stdint.h"
+#include "string.h"
+
+#include "bob3000/Bob.hpp"
+#include "btp6000/Btp.hpp"
+#include "btp6000/Jit.hpp"
+
+#define BENCH_ACCESSES 100000000
+#define ROM_PAGE       0x20
+#define DEVICE_PAGE    0x40
+
+// A register file that counts reads and remembers the last write
+class Registers : public Bob3kDevice {
+public:
+    uint32_t reads = 0;
+    uint16_t lastAddress = 0;
+    uint8_t lastValue = 0;
+
+    // Returns the low byte of the address
+    uint8_t Read( uint16_t address ) override {
+        reads++;
+        return (uint8_t)address;
+    }
+
+    // Remembers the write
+    void Write( uint16_t address, uint8_t value ) override {
+        lastAddress = address;
+        lastValue = value;
+    }
+};
+
+// Remembers the last page written to
+class PageLog : public Bob3kWatcher {
+public:
+    int page = -1;
+
+    // Remembers the page
+    void PageWritten( uint8_t page ) override {
+        this->page = page;
+    }
+};
+
+// A page of code that can change without being written to: an LDB of
+// `value`, then a jump back to it
+class CodeRom : public Bob3kDevice {
+public:
+    uint8_t code[5] = { 0xB0, 0x00, 0x00, 0xC5, 0xFB }; // ldb 0; jmp -5
+
+    // Changes the value loaded
+    void SetValue( uint16_t value ) {
+        code[1] = (uint8_t)value;
+        code[2] = (uint8_t)( value >> 8 );
+    }
+
+    // Returns the code, then zeros
+    uint8_t Read( uint16_t address ) override {
+        uint8_t offset = address & 0xFF;
+        return offset < sizeof( code ) ? code[offset] : 0;
+    }
+};
+
+// Prints a failed check and returns false
+bool Fail( const char *what ) {
+    printf( "%s\n", what );
+    return false;
+}
+
+// Returns false unless every kind of page behaves as mapped
+bool Check( Bob3k &memory ) {
+    Registers registers;
+    PageLog log;
+    int slot = memory.AddWatcher( &log );
+
+    memset( memory.data(), 0xAA, BOB3K_SIZE );
+    memory.MapReadOnly( ROM_PAGE, 1 );
+    memory.MapDevice( DEVICE_PAGE, 1, &registers );
+
+    // Read-only pages read the buffer, drop writes and notify nobody
+    memory.WatchPage( ROM_PAGE, slot );
+    memory.Write( ROM_PAGE << 8, 0x12 );
+    memory.Write16( ( ROM_PAGE << 8 ) + 2, 0x3456 );
+    if (
+        memory.Read( ROM_PAGE << 8 ) != 0xAA ||
+        memory.Read16( ( ROM_PAGE << 8 ) + 2 ) != 0xAAAA || log.page != -1
+    )
+        return Fail( "read-only page was written to" );
+
+    // A word straddling RAM and a read-only page only changes the RAM byte
+    memory.WatchPage( ROM_PAGE - 1, slot );
+    memory.Write16( ( ROM_PAGE << 8 ) - 1, 0x1234 );
+    if (
+        memory.Read16( ( ROM_PAGE << 8 ) - 1 ) != 0xAA34 ||
+        log.page != ROM_PAGE - 1
+    )
+        return Fail( "word across a read-only page" );
+
+    // Device pages never touch the buffer
+    memory.Write16( ( DEVICE_PAGE << 8 ) + 0x10, 0xBEEF );
+    if (
+        registers.lastAddress != ( DEVICE_PAGE << 8 ) + 0x11 ||
+        registers.lastValue != 0xBE ||
+        memory.data()[( DEVICE_PAGE << 8 ) + 0x10] != 0xAA
+    )
+        return Fail( "device write" );
+    if (
+        memory.Read16( ( DEVICE_PAGE << 8 ) + 0x20 ) != 0x2120 ||
+        memory.Read16( ( DEVICE_PAGE << 8 ) - 1 ) != 0x00AA ||
+        registers.reads != 3
+    )
+        return Fail( "device read" );
+
+    // Words still wrap around the end of memory
+    memory.MapDevice( 0xFF, 1, &registers );
+    memory.Write16( 0xFFFF, 0x5678 );
+    if (
+        registers.lastAddress != 0xFFFF || registers.lastValue != 0x78 ||
+        memory.Read( 0 ) != 0x56 || memory.Read16( 0xFFFF ) != 0x56FF
+    )
+        return Fail( "wrap around the end of memory" );
+
+    // Back to RAM
+    memory.MapRam( 0, BOB3K_PAGE_COUNT );
+    memory.Write( ROM_PAGE << 8, 0x12 );
+    if ( memory.Read( ROM_PAGE << 8 ) != 0x12 || memory.HasDevices() )
+        return Fail( "remapping as RAM" );
+
+    memory.RemoveWatcher( slot );
+    return true;
+}
+
+// Returns false unless writes mark exactly their blocks dirty
+bool CheckDirty( Bob3k &memory ) {
+    Registers registers;
+    memory.MapReadOnly( ROM_PAGE, 1 );
+    memory.MapDevice( DEVICE_PAGE, 1, &registers );
+    memory.ClearDirty();
+
+    memory.Write( 0x1234, 1 );
+    memory.Write16( 0x127F, 2 );
+    memory.Write( ROM_PAGE << 8, 3 );
+    memory.Write16( DEVICE_PAGE << 8, 4 );
+    if (
+        !memory.IsDirty( 0x1200, 1 ) || !memory.IsDirty( 0x123F, 1 ) ||
+        !memory.IsDirty( 0x1240, 0x40 ) || !memory.IsDirty( 0x1280, 1 ) ||
+        memory.IsDirty( 0x12C0, 0x40 ) || memory.IsDirty( 0x11C0, 0x40 ) ||
+        !memory.IsDirty( 0x1000, 0x1000 ) ||
+        memory.IsDirty( ROM_PAGE << 8, BOB3K_PAGE_SIZE ) ||
+        memory.IsDirty( DEVICE_PAGE << 8, BOB3K_PAGE_SIZE )
+    )
+        return Fail( "writes marked the wrong blocks" );
+
+    // Ranges wrap around the end of memory
+    memory.ClearDirty();
+    memory.MarkDirty( 0xFFF0, 0x20 );
+    if (
+        !memory.IsDirty( 0xFFC0, 1 ) || !memory.IsDirty( 0, 1 ) ||
+        memory.IsDirty( 0x40, 0xFF80 ) || !memory.IsDirty( 0xFF00, 0x200 )
+    )
+        return Fail( "ranges around the end of memory" );
+
+    memory.ClearDirty();
+    if ( memory.IsDirty( 0, BOB3K_SIZE ) )
+        return Fail( "clearing the dirty map" );
+    memory.Restore( memory.data() );
+    if ( !memory.IsDirty( DEVICE_PAGE << 8, 1 ) )
+        return Fail( "restoring did not dirty everything" );
+
+    memory.MapRam( 0, BOB3K_PAGE_COUNT );
+    return true;
+}
+
+// Returns false if the CPU runs code it decoded or translated before its page
+// was remapped, or code read through a device as it was the first time,
+// instead of what reading memory returns now
+bool CheckCode( Bob3k &memory ) {
+    const uint8_t ram[] = { 0xA0, 0x34, 0x12, 0xC5, 0xFB }; // lda; jmp -5
+    CodeRom rom;
+    btp::BetterThanPico cpu;
+    cpu.Reset();
+    cpu.SetMemory( &memory );
+    cpu.SetIdleSkipping( false );
+
+    // Interpreter
+    memset( memory.data(), 0, BOB3K_SIZE );
+    memcpy( memory.data() + ( ROM_PAGE << 8 ), ram, sizeof( ram ) );
+    cpu.CS = ROM_PAGE << 4;
+    cpu.Execute();
+    if ( cpu.A.value != 0x1234 )
+        return Fail( "running code from RAM" );
+
+    rom.SetValue( 0x5678 );
+    memory.MapDevice( ROM_PAGE, 1, &rom );
+    cpu.IP = 0;
+    cpu.Execute();
+    if ( cpu.B.value != 0x5678 )
+        return Fail( "decoded code outlived remapping its page" );
+
+    rom.SetValue( 0x9ABC );
+    cpu.IP = 0;
+    cpu.Execute();
+    if ( cpu.B.value != 0x9ABC )
+        return Fail( "code read through a device was decoded once" );
+    memory.MapRam( 0, BOB3K_PAGE_COUNT );
+
+    // Recompiler, with a device elsewhere all along, so that remapping does
+    // not flush it for reading through devices
+    Registers registers;
+    memory.MapDevice( DEVICE_PAGE, 1, &registers );
+    btp::Jit jit( &cpu );
+    cpu.A.value = cpu.B.value = 0;
+    cpu.IP = 0;
+    jit.RunCycles( 1000 );
+    if ( cpu.A.value != 0x1234 )
+        return Fail( "translating code in RAM" );
+
+    rom.SetValue( 0x5678 );
+    memory.MapDevice( ROM_PAGE, 1, &rom );
+    cpu.IP = 0;
+    jit.RunCycles( 1000 );
+    if ( cpu.B.value != 0x5678 )
+        return Fail( "translated code outlived remapping its page" );
+
+    rom.SetValue( 0x9ABC );
+    jit.RunCycles( 1000 );
+    if ( cpu.B.value != 0x9ABC )
+        return Fail( "code read through a device was translated" );
+
+    memory.MapRam( 0, BOB3K_PAGE_COUNT );
+    return true;
+}
+
+// Takes a watcher slot and ignores every write
+class Squatter : public Bob3kWatcher {
+public:
+    // Ignores the page
+    void PageWritten( uint8_t page ) override {}
+};
+
+// Returns false if the CPU runs stale code after code is overwritten while
+// every watcher slot was taken before it got one
+bool CheckNoWatchers( Bob3k &memory ) {
+    const uint8_t code[] = { 0xA0, 0x34, 0x12, 0xC5, 0xFB }; // lda; jmp -5
+    Squatter squatters[BOB3K_WATCHER_MAX];
+    int slots[BOB3K_WATCHER_MAX];
+    for ( int i = 0; i < BOB3K_WATCHER_MAX; i++ )
+        slots[i] = memory.AddWatcher( &squatters[i] );
+
+    memset( memory.data(), 0, BOB3K_SIZE );
+    memcpy( memory.data() + ( ROM_PAGE << 8 ), code, sizeof( code ) );
+    bool passed = true;
+    {
+        btp::BetterThanPico cpu;
+        cpu.Reset();
+        cpu.SetMemory( &memory );
+        cpu.SetIdleSkipping( false );
+        cpu.CS = ROM_PAGE << 4;
+
+        cpu.Execute();
+        memory.Write16( ( ROM_PAGE << 8 ) + 1, 0x5678 );
+        cpu.IP = 0;
+        cpu.Execute();
+        if ( cpu.A.value != 0x5678 )
+            passed = Fail( "decoded code outlived a write without a watcher" );
+
+        btp::Jit jit( &cpu );
+        cpu.IP = 0;
+        jit.RunCycles( 1000 );
+        memory.Write16( ( ROM_PAGE << 8 ) + 1, 0x9ABC );
+        cpu.IP = 0;
+        jit.RunCycles( 1000 );
+        if ( cpu.A.value != 0x9ABC )
+            passed =
+                Fail( "translated code outlived a write without a watcher" );
+    }
+
+    for ( int slot : slots )
+        memory.RemoveWatcher( slot );
+    return passed;
+}
+
+// Reads and writes words all over a page and returns the ns per access
+double Bench( Bob3k &memory, uint8_t page ) {
+    using Clock = std::chrono::steady_clock;
+
+    uint16_t sum = 0;
+    Clock::time_point start = Clock::now();
+    for ( uint32_t i = 0; i < BENCH_ACCESSES / 2; i++ ) {
+        uint16_t address = ( page << 8 ) | ( i * 7 & 0xFE );
+        sum += memory.Read16( address );
+        memory.Write16( address, sum );
+    }
+    double seconds =
+        std::chrono::duration<double>( Clock::now() - start ).count();
+
+    // Keep the loop from being optimised out
+    if ( sum == 0x1234 )
+        printf( " " );
+    return seconds * 1e9 / BENCH_ACCESSES;
+}
+
+int main() {
+    static Bob3k memory;
+    if (
+        !Check( memory ) || !CheckDirty( memory ) || !CheckCode( memory ) ||
+        !CheckNoWatchers( memory )
+    ) {
+        printf( "Memory check: FAILED\n" );
+        return 1;
+    }
+    printf( "Memory check: passed\n" );
+
+    Registers registers;
+    memory.MapReadOnly( ROM_PAGE, 1 );
+    memory.MapDevice( DEVICE_PAGE, 1, &registers );
+    printf( "ram        %.2f ns per access\n", Bench( memory, 0x10 ) );
+    printf( "read-only  %.2f ns per access\n", Bench( memory, ROM_PAGE ) );
+    printf( "device     %.2f ns per access\n", Bench( memory, DEVICE_PAGE ) );
+    memory.MapRam( 0, BOB3K_PAGE_COUNT );
+
+    return 0;
+}
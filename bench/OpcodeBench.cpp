@@ -0,0 +1,191 @@
+/*
+* Copyright © 2025 Micro-16 Team
+* 
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the “Software”), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+* 
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+* 
+* THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+// Times each family of BTP6000 opcodes on its own and prints the results as
+// JSON. Every family is a block of FAMILY_BLOCK_LENGTH instructions followed
+// by a jmp back to its start, so one instruction in FAMILY_BLOCK_LENGTH + 1 is
+// the jmp. Build it with and without BTP_THREADED to compare the cores (see
+// the Makefile).
+
+#include <chrono>
+#include <vector>
+
+#include "stdio.h"
+#include "stdint.h"
+#include "stdlib.h"
+#include "string.h"
+
+#include "btp6000/Btp.hpp"
+
+#ifdef BTP_THREADED
+#define CORE_NAME "threaded"
+#else
+#define CORE_NAME "switch"
+#endif
+
+#define BENCH_SECONDS       0.5
+#define FAMILY_ORIGIN       0x1000
+#define FAMILY_BLOCK_LENGTH 32 // Must stay within reach of a short jmp
+
+using namespace btp;
+
+// Instructions that are repeated to fill a family's block
+struct Family {
+    const char *name;
+    std::vector<std::vector<uint8_t>> instructions;
+};
+
+// Memory starts zeroed with SS, DS, BP, X and Y at 0, and loads only read
+// zeroes back, so every offset and pointer stays in page 0 below the code
+const Family families[] = {
+    { "immediates", {
+        { INS_LDA_IM, 0x34, 0x12 },
+        { INS_LDB_IM, 0x34, 0x12 },
+        { INS_LDX_IM, 0x00, 0x00 },
+        { INS_LDY_IM, 0x00, 0x00 },
+    } },
+    { "stack_offset_loads", {
+        { INS_LDA_SO },
+        { INS_LDB_SO, 0x10 },
+        { INS_LDX_SO, 0x20 },
+        { INS_LDY_SO },
+    } },
+    { "data_offset_loads", {
+        { INS_LDA_DO },
+        { INS_LDB_DO, 0x10 },
+        { INS_LDX_DO, 0x20 },
+        { INS_LDY_DO },
+    } },
+    { "pointer_offset_loads", {
+        { INS_LDA_SPO },
+        { INS_LDB_SPO, 0x10, 0x08, 0x00 },
+        { INS_LDX_SPO, 0x20 },
+        { INS_LDY_SPO, 0x08, 0x00 },
+        { INS_LDA_DPO },
+        { INS_LDB_DPO, 0x10, 0x08, 0x00 },
+        { INS_LDX_DPO, 0x20 },
+        { INS_LDY_DPO, 0x08, 0x00 },
+    } },
+    { "stores", {
+        { INS_STA_SO },
+        { INS_STB_SO, 0x10 },
+        { INS_STX_DO, 0x20 },
+        { INS_STY_DO },
+        { INS_STA_SPO },
+        { INS_STB_DPO, 0x10, 0x08, 0x00 },
+    } },
+    { "transfers", {
+        { INS_TAB }, { INS_TAX }, { INS_TAY },
+        { INS_TBA }, { INS_TBX }, { INS_TBY },
+        { INS_TXA }, { INS_TXB }, { INS_TXY },
+        { INS_TYA }, { INS_TYB }, { INS_TYX },
+    } },
+    { "push_pop", {
+        { INS_PUSHA }, { INS_POPA },
+        { INS_PUSHB }, { INS_POPB },
+        { INS_PUSHX }, { INS_POPX },
+        { INS_PUSHY }, { INS_POPY },
+        { INS_ENTER }, { INS_LEAVE },
+    } },
+};
+
+// Writes a family's block and the jmp back, and points the CPU at it
+void LoadFamily( const Family &family, Bob3k &memory, BetterThanPico &cpu ) {
+    memset( memory.data(), 0, BOB3K_SIZE );
+
+    uint16_t address = FAMILY_ORIGIN;
+    for ( int i = 0; i < FAMILY_BLOCK_LENGTH; i++ ) {
+        const std::vector<uint8_t> &instruction =
+            family.instructions[i % family.instructions.size()];
+        memcpy(
+            memory.data() + address, instruction.data(), instruction.size()
+        );
+        address += instruction.size();
+    }
+
+    int distance = FAMILY_ORIGIN - ( address + 2 );
+    if ( distance < INT8_MIN ) {
+        fprintf( stderr, "The %s block is too long for a jmp!\n", family.name );
+        exit( 1 );
+    }
+    memory.Write( address, INS_JMP );
+    memory.Write( address + 1, (uint8_t)distance );
+
+    cpu.Reset();
+    cpu.CS = FAMILY_ORIGIN >> 4;
+}
+
+// Runs a family for about BENCH_SECONDS and prints its JSON object
+void Bench(
+    const Family &family,
+    Bob3k &memory,
+    BetterThanPico &cpu,
+    bool last
+) {
+    using Clock = std::chrono::steady_clock;
+
+    uint64_t instructions = 0, cycles = 0;
+    double seconds = 0.0;
+
+    LoadFamily( family, memory, cpu );
+    Clock::time_point start = Clock::now();
+
+    while ( seconds < BENCH_SECONDS ) {
+        RunResult result = cpu.RunCycles( CYCLES_PER_FRAME );
+        instructions += result.instructions;
+        cycles += result.cycles;
+
+        seconds =
+            std::chrono::duration<double>( Clock::now() - start ).count();
+    }
+
+    printf(
+        "    { \"family\": \"%s\", \"instructions\": %llu, "
+        "\"cycles\": %llu, \"seconds\": %.6f, "
+        "\"ns_per_instruction\": %.3f, \"instructions_per_second\": %.0f }%s\n",
+        family.name,
+        (unsigned long long)instructions, (unsigned long long)cycles,
+        seconds, seconds * 1e9 / instructions, instructions / seconds,
+        last ? "" : ","
+    );
+}
+
+int main() {
+    static Bob3k memory;
+    BetterThanPico cpu;
+    cpu.SetMemory( &memory );
+    cpu.SetIdleSkipping( false ); // Loads-only families would be skipped
+
+    const int familyCount = sizeof( families ) / sizeof( families[0] );
+
+    printf( "{\n" );
+    printf( "  \"core\": \"%s\",\n", CORE_NAME );
+    printf( "  \"block_length\": %d,\n", FAMILY_BLOCK_LENGTH );
+    printf( "  \"results\": [\n" );
+    for ( int i = 0; i < familyCount; i++ )
+        Bench( families[i], memory, cpu, i == familyCount - 1 );
+    printf( "  ]\n" );
+    printf( "}\n" );
+
+    return 0;
+}
@@ -0,0 +1,462 @@
+/*
+* Copyright © 2025 Micro-16 Team
+* 
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the “Software”), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+* 
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+* 
+* THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+// Checks that sprites, the background layer and the sprites in OAM draw
+// exactly like decoding the sprites a bit at a time straight from memory
+// does, also after sprites are rewritten and at every scroll, with every set
+// of kernels this host runs. Then times, with each set, a full-screen
+// background against 256 RenderSprite() calls and 64 sprites drawn from OAM
+// against 64 RenderSprite() calls.
+
+#include <chrono>
+#include <random>
+
+#include "stdio.h"
+#include "stdint.h"
+#include "string.h"
+
+#define SCREEN_RESOLUTION 128
+
+#include "pgu7000/Pgu.hpp"
+
+#define BENCH_SCREENS 2000
+#define BENCH_RUNS    10
+
+using namespace pgu;
+
+// Fills the video memory with random sprites, nametables and palettes
+void Randomize( Bob3k &memory, std::mt19937 &random ) {
+    for ( int i = SPRITESHEET; i < PALETTE; i++ )
+        memory.Write( i, (uint8_t)random() );
+    for ( int i = 0; i < PALETTE_SIZE; i++ )
+        memory.Write( PALETTE + i, random() % COLOR_COUNT );
+}
+
+// Draws a sprite a bit at a time from memory, the way the PGU first did
+void ReferenceSprite(
+    MiDi16::Surface &screen, Bob3k &memory,
+    uint8_t sprite, uint8_t palette, int x, int y
+) {
+    static const MiDi16::Color colors[COLOR_COUNT] = {
+        { 0x0A, 0x08, 0x0D, 0xFF }, { 0x69, 0x75, 0x94, 0xFF },
+        { 0xDF, 0xE9, 0xF5, 0xFF }, { 0xF7, 0xAA, 0xA8, 0xFF },
+        { 0xD4, 0x68, 0x9A, 0xFF }, { 0x78, 0x2C, 0x96, 0xFF },
+        { 0xE8, 0x35, 0x62, 0xFF }, { 0xF2, 0x82, 0x5C, 0xFF },
+        { 0xFF, 0xC7, 0x6E, 0xFF }, { 0x88, 0xC4, 0x4D, 0xFF },
+        { 0x3F, 0x9E, 0x59, 0xFF }, { 0x37, 0x34, 0x61, 0xFF },
+        { 0x48, 0x54, 0xA8, 0xFF }, { 0x71, 0x99, 0xD9, 0xFF },
+        { 0x9E, 0x52, 0x52, 0xFF }, { 0x4D, 0x25, 0x36, 0xFF },
+    };
+    uint16_t spriteAddress = SPRITESHEET + sprite * SPRITE_SIZE;
+    uint16_t paletteAddress = PALETTE + 1 + palette * PALETTE_ENTRY_SIZE;
+
+    for ( int j = 0; j < SPRITE_WIDTH; j++ ) {
+        uint8_t lsb = memory.Read( spriteAddress + j );
+        uint8_t msb = memory.Read( spriteAddress + j + SPRITE_WIDTH );
+
+        for ( int i = SPRITE_WIDTH - 1; i > -1; i-- ) {
+            uint8_t paletteIndex = ( ( msb & 1 ) << 1 ) | ( lsb & 1 );
+            lsb >>= 1;
+            msb >>= 1;
+
+            uint8_t color = paletteIndex == 0 ?
+                memory.Read( PALETTE ) :
+                memory.Read( paletteAddress + paletteIndex );
+            screen.Set( x + i, y + j, colors[color] );
+        }
+    }
+}
+
+// Draws the nametables a sprite at a time, the way the background layer
+// should
+void RenderReference( MiDi16::Surface &screen, Bob3k &memory ) {
+    int scroll = memory.Read( SCROLL_X );
+    for ( int row = 0; row < NAMETABLE_WIDTH; row++ )
+        for ( int column = 0; column < NAMETABLE_WIDTH * 2; column++ ) {
+            uint16_t nametable =
+                column < NAMETABLE_WIDTH ? NAMETABLE0 : NAMETABLE1;
+            uint16_t entry = nametable + NAMETABLE_ENTRY_SIZE * (
+                row * NAMETABLE_WIDTH + column % NAMETABLE_WIDTH
+            );
+            uint8_t sprite = memory.Read( entry ) % SPRITESHEET_SPRITE_COUNT;
+            uint8_t palette = memory.Read( entry + 1 ) % PALETTE_ENTRY_COUNT;
+
+            // Once where it is and once wrapped around
+            int x = column * SPRITE_WIDTH - scroll;
+            int y = row * SPRITE_WIDTH;
+            ReferenceSprite( screen, memory, sprite, palette, x, y );
+            ReferenceSprite(
+                screen, memory,
+                sprite, palette, x + NAMETABLE_WIDTH * 2 * SPRITE_WIDTH, y
+            );
+        }
+}
+
+// Draws the sprites of OAM a bit at a time from memory, last entry first,
+// the way the sprite layer should
+void ReferenceObjects( MiDi16::Surface &screen, Bob3k &memory ) {
+    for ( int entry = OAM_ENTRY_COUNT - 1; entry >= 0; entry-- ) {
+        uint16_t address = OAM + entry * OAM_ENTRY_SIZE;
+        int x = memory.Read( address ) - OAM_OFFSET;
+        int y = memory.Read( address + 1 ) - OAM_OFFSET;
+        uint8_t sprite = memory.Read( address + 2 ) % SPRITESHEET_SPRITE_COUNT;
+        uint8_t attributes = memory.Read( address + 3 );
+
+        // Draw the sprite opaque on its own, then copy its pixels that are
+        // not palette index 0
+        MiDi16::Surface opaque( SPRITE_WIDTH, SPRITE_WIDTH );
+        ReferenceSprite(
+            opaque, memory, sprite, attributes & ATTRIBUTE_PALETTE, 0, 0
+        );
+        uint16_t spriteAddress = SPRITESHEET + sprite * SPRITE_SIZE;
+        for ( int j = 0; j < SPRITE_WIDTH; j++ )
+            for ( int i = 0; i < SPRITE_WIDTH; i++ ) {
+                int column = attributes & ATTRIBUTE_FLIP_X ? 7 - i : i;
+                int row = attributes & ATTRIBUTE_FLIP_Y ? 7 - j : j;
+                uint16_t rowAddress = spriteAddress + row;
+                int bit = 7 - column;
+                bool lsb = memory.Read( rowAddress ) >> bit & 1;
+                bool msb = memory.Read( rowAddress + SPRITE_WIDTH ) >> bit & 1;
+                if ( lsb || msb )
+                    screen.Set( x + i, y + j, opaque.Get( column, row ) );
+            }
+    }
+}
+
+// Returns true if both surfaces hold the same pixels
+bool SameScreens( MiDi16::Surface &a, MiDi16::Surface &b ) {
+    for ( int y = 0; y < SCREEN_RESOLUTION; y++ )
+        if (
+            memcmp(
+                a.Row( y ), b.Row( y ),
+                SCREEN_RESOLUTION * sizeof( MiDi16::Color )
+            )
+        )
+            return false;
+    return true;
+}
+
+// Returns true if sprites drawn anywhere, partly off the screen too, match
+// the reference while a few sprites and a palette color are rewritten every
+// frame
+bool CheckSprites( KernelLevel level ) {
+    static Bob3k memory;
+    MiDi16::Surface screen( SCREEN_RESOLUTION, SCREEN_RESOLUTION );
+    MiDi16::Surface reference( SCREEN_RESOLUTION, SCREEN_RESOLUTION );
+    PixelGraphicsUnit gpu( &screen );
+    gpu.SetMemory( &memory );
+    gpu.SetKernels( level );
+
+    std::mt19937 random( 22 );
+    Randomize( memory, random );
+    for ( int frame = 0; frame < 200; frame++ ) {
+        for ( int i = 0; i < 8; i++ )
+            memory.Write(
+                SPRITESHEET + random() % ( SPRITESHEET_SPRITE_COUNT *
+                SPRITE_SIZE ), random()
+            );
+        memory.Write(
+            PALETTE + random() % PALETTE_SIZE, random() % COLOR_COUNT
+        );
+        gpu.Latch();
+        memory.ClearDirty();
+
+        for ( int i = 0; i < 64; i++ ) {
+            uint8_t sprite = random() % SPRITESHEET_SPRITE_COUNT;
+            uint8_t palette = random() % PALETTE_ENTRY_COUNT;
+            int x = (int)( random() % ( SCREEN_RESOLUTION + 16 ) ) - 8;
+            int y = (int)( random() % ( SCREEN_RESOLUTION + 16 ) ) - 8;
+            gpu.RenderSprite( sprite, palette, x, y );
+            ReferenceSprite( reference, memory, sprite, palette, x, y );
+        }
+        if ( !SameScreens( screen, reference ) ) {
+            printf( "  frame %d differs\n", frame );
+            return false;
+        }
+    }
+    return true;
+}
+
+// Returns true if the background matches the reference at every scroll
+bool CheckBackground( KernelLevel level ) {
+    static Bob3k memory;
+    MiDi16::Surface background( SCREEN_RESOLUTION, SCREEN_RESOLUTION );
+    MiDi16::Surface reference( SCREEN_RESOLUTION, SCREEN_RESOLUTION );
+    PixelGraphicsUnit gpu( &background );
+    gpu.SetMemory( &memory );
+    gpu.SetKernels( level );
+
+    std::mt19937 random( 16 );
+    for ( int round = 0; round < 4; round++ ) {
+        Randomize( memory, random );
+        memory.Write( CONTROL, CONTROL_BACKGROUND );
+
+        for ( int scroll = 0; scroll < 256; scroll++ ) {
+            memory.Write( SCROLL_X, scroll );
+            gpu.Latch();
+            memory.ClearDirty();
+
+            background.Clear();
+            gpu.Render();
+            reference.Clear();
+            RenderReference( reference, memory );
+
+            if ( !SameScreens( background, reference ) ) {
+                printf( "  scroll %d differs\n", scroll );
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Returns true if the sprite layer over the background matches the reference
+// for random OAM
+bool CheckObjects( KernelLevel level ) {
+    static Bob3k memory;
+    MiDi16::Surface screen( SCREEN_RESOLUTION, SCREEN_RESOLUTION );
+    MiDi16::Surface reference( SCREEN_RESOLUTION, SCREEN_RESOLUTION );
+    PixelGraphicsUnit gpu( &screen );
+    gpu.SetMemory( &memory );
+    gpu.SetKernels( level );
+
+    std::mt19937 random( 25 );
+    Randomize( memory, random );
+    memory.Write( CONTROL, CONTROL_BACKGROUND | CONTROL_SPRITES );
+    for ( int frame = 0; frame < 1000; frame++ ) {
+        // Some frames only have sprites near the edges
+        int range = frame % 2 ? 256 : SCREEN_RESOLUTION + 2 * OAM_OFFSET;
+        for ( int i = 0; i < OAM_SIZE; i += OAM_ENTRY_SIZE ) {
+            memory.Write( OAM + i, random() % range );
+            memory.Write( OAM + i + 1, random() % range );
+            memory.Write( OAM + i + 2, random() );
+            memory.Write( OAM + i + 3, random() );
+        }
+        memory.Write( SCROLL_X, random() );
+        gpu.Latch();
+        memory.ClearDirty();
+
+        screen.Clear();
+        gpu.Render();
+        reference.Clear();
+        RenderReference( reference, memory );
+        ReferenceObjects( reference, memory );
+
+        if ( !SameScreens( screen, reference ) ) {
+            printf( "  frame %d differs\n", frame );
+            return false;
+        }
+    }
+    return true;
+}
+
+// Returns the microseconds it takes to draw 64 sprites with a set of kernels,
+// either from OAM or as 64 RenderSprite() calls
+double BenchObjects( KernelLevel level, bool oam ) {
+    using Clock = std::chrono::steady_clock;
+
+    static Bob3k memory;
+    MiDi16::Surface screen( SCREEN_RESOLUTION, SCREEN_RESOLUTION );
+    PixelGraphicsUnit gpu( &screen );
+    gpu.SetMemory( &memory );
+    gpu.SetKernels( level );
+    std::mt19937 random( 25 );
+    Randomize( memory, random );
+
+    // Everywhere on the screen, a few clipped at the edges
+    int x[OAM_ENTRY_COUNT], y[OAM_ENTRY_COUNT];
+    uint8_t sprite[OAM_ENTRY_COUNT], palette[OAM_ENTRY_COUNT];
+    for ( int i = 0; i < OAM_ENTRY_COUNT; i++ ) {
+        x[i] = (int)( random() % ( SCREEN_RESOLUTION + 4 ) ) - 2;
+        y[i] = (int)( random() % ( SCREEN_RESOLUTION + 4 ) ) - 2;
+        sprite[i] = random() % SPRITESHEET_SPRITE_COUNT;
+        palette[i] = random() % PALETTE_ENTRY_COUNT;
+
+        uint16_t address = OAM + i * OAM_ENTRY_SIZE;
+        memory.Write( address, x[i] + OAM_OFFSET );
+        memory.Write( address + 1, y[i] + OAM_OFFSET );
+        memory.Write( address + 2, sprite[i] );
+        memory.Write( address + 3, palette[i] );
+    }
+    gpu.Latch();
+
+    double best = 1e9;
+    for ( int run = 0; run < BENCH_RUNS; run++ ) {
+        Clock::time_point start = Clock::now();
+        for ( int i = 0; i < BENCH_SCREENS; i++ ) {
+            if ( oam ) {
+                gpu.RenderObjects();
+                continue;
+            }
+            for ( int j = OAM_ENTRY_COUNT - 1; j >= 0; j-- )
+                gpu.RenderSprite( sprite[j], palette[j], x[j], y[j] );
+        }
+        double seconds =
+            std::chrono::duration<double>( Clock::now() - start ).count();
+        if ( seconds < best )
+            best = seconds;
+    }
+
+    // Keep the drawing from being optimized away
+    if ( screen.Get( 5, 5 ).a == 0x12 )
+        printf( " " );
+    return best * 1e6 / BENCH_SCREENS;
+}
+
+// Returns the microseconds it takes to draw the whole screen with a set of
+// kernels, either as a background or as 256 RenderSprite() calls
+double Bench( KernelLevel level, bool background ) {
+    using Clock = std::chrono::steady_clock;
+
+    static Bob3k memory;
+    MiDi16::Surface screen( SCREEN_RESOLUTION, SCREEN_RESOLUTION );
+    PixelGraphicsUnit gpu( &screen );
+    gpu.SetMemory( &memory );
+    gpu.SetKernels( level );
+    std::mt19937 random( 16 );
+    Randomize( memory, random );
+    memory.Write( SCROLL_X, 3 );
+    gpu.Latch();
+
+    // The best of a few runs, since a screen only takes microseconds
+    double best = 1e9;
+    for ( int run = 0; run < BENCH_RUNS; run++ ) {
+        Clock::time_point start = Clock::now();
+        for ( int i = 0; i < BENCH_SCREENS; i++ ) {
+            if ( background ) {
+                gpu.RenderBackground();
+                continue;
+            }
+            for ( int row = 0; row < NAMETABLE_WIDTH; row++ )
+                for ( int column = 0; column < NAMETABLE_WIDTH; column++ )
+                    gpu.RenderSprite(
+                        row * NAMETABLE_WIDTH + column, column,
+                        column * SPRITE_WIDTH, row * SPRITE_WIDTH
+                    );
+        }
+        double seconds =
+            std::chrono::duration<double>( Clock::now() - start ).count();
+        if ( seconds < best )
+            best = seconds;
+    }
+
+    // Keep the drawing from being optimized away
+    if ( screen.Get( 5, 5 ).a == 0x12 )
+        printf( " " );
+    return best * 1e6 / BENCH_SCREENS;
+}
+
+// Returns true if a set of kernels decodes and colors random tiles exactly
+// like the scalar ones
+bool CheckKernels( KernelLevel level ) {
+    const Kernels &scalar = GetKernels( KERNELS_SCALAR );
+    const Kernels &kernels = GetKernels( level );
+    std::mt19937 random( 23 );
+
+    for ( int round = 0; round < 100000; round++ ) {
+        uint8_t planes[TILE_BITPLANE_SIZE];
+        MiDi16::Color colors[4], blendColors[4];
+        for ( int i = 0; i < TILE_BITPLANE_SIZE; i++ )
+            planes[i] = random();
+        for ( int i = 0; i < 4; i++ ) {
+            colors[i] = {
+                (uint8_t)random(), (uint8_t)random(),
+                (uint8_t)random(), (uint8_t)random()
+            };
+            blendColors[i] = { colors[i].b, colors[i].r, colors[i].g, 0 };
+        }
+
+        uint8_t expected[TILE_PIXELS], tile[TILE_PIXELS];
+        scalar.DecodeTile( planes, expected );
+        kernels.DecodeTile( planes, tile );
+        if ( memcmp( expected, tile, TILE_PIXELS ) ) {
+            printf( "  %s decodes a tile differently\n", kernels.name );
+            return false;
+        }
+
+        // Rows a few pixels apart, which must be left alone
+        constexpr int STRIDE = TILE_WIDTH + 3;
+        MiDi16::Color expectedPixels[TILE_WIDTH * STRIDE] = {};
+        MiDi16::Color pixels[TILE_WIDTH * STRIDE] = {};
+        scalar.ColorTile( tile, colors, expectedPixels, STRIDE );
+        kernels.ColorTile( tile, colors, pixels, STRIDE );
+        if ( memcmp( expectedPixels, pixels, sizeof( pixels ) ) ) {
+            printf( "  %s colors a tile differently\n", kernels.name );
+            return false;
+        }
+
+        // Over the pixels that are already there, the second sprite on
+        // top and clipped on some lines
+        LineSprite sprites[2] = {
+            {
+                tile + ( TILE_WIDTH - 1 ) * TILE_WIDTH, colors,
+                3, 0, -TILE_WIDTH, round % 3, TILE_WIDTH - round % 4
+            },
+            { tile, blendColors, 0, 0, TILE_WIDTH, 0, TILE_WIDTH },
+        };
+        for ( int j = 0; j < TILE_WIDTH; j++ ) {
+            scalar.BlendLine( sprites, 3, j, expectedPixels + j * STRIDE );
+            kernels.BlendLine( sprites, 3, j, pixels + j * STRIDE );
+        }
+        if ( memcmp( expectedPixels, pixels, sizeof( pixels ) ) ) {
+            printf( "  %s blends a row differently\n", kernels.name );
+            return false;
+        }
+    }
+    return true;
+}
+
+int main() {
+    for ( int level = 0; level <= BestKernelLevel(); level++ )
+        if (
+            !CheckKernels( (KernelLevel)level ) ||
+            !CheckSprites( (KernelLevel)level ) ||
+            !CheckBackground( (KernelLevel)level ) ||
+            !CheckObjects( (KernelLevel)level )
+        ) {
+            printf( "PGU check: FAILED\n" );
+            return 1;
+        }
+    printf( "PGU check: passed\n" );
+
+    for ( int level = 0; level <= BestKernelLevel(); level++ ) {
+        const char *name = GetKernels( (KernelLevel)level ).name;
+        printf(
+            "%-8s background %6.2f us per screen\n",
+            name, Bench( (KernelLevel)level, true )
+        );
+        printf(
+            "%-8s sprites    %6.2f us per 256\n",
+            name, Bench( (KernelLevel)level, false )
+        );
+        printf(
+            "%-8s oam        %6.2f us per 64\n",
+            name, BenchObjects( (KernelLevel)level, true )
+        );
+        printf(
+            "%-8s sprites    %6.2f us per 64\n",
+            name, BenchObjects( (KernelLevel)level, false )
+        );
+    }
+    return 0;
+}
@@ -0,0 +1,122 @@
+/*
+* Copyright © 2025 Micro-16 Team
+* 
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the “Software”), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+* 
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+* 
+* THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+// Steps a pool of headless consoles on more and more threads, checking that
+// every console ends up exactly where it does on one thread, and prints how
+// the throughput scales.
+
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "stdio.h"
+#include "stdint.h"
+#include "string.h"
+
+#include "console/ConsolePool.hpp"
+
+#include "Programs.hpp"
+
+#define POOL_CONSOLES 512
+#define POOL_FRAMES   30
+
+// Runs every console of a pool for POOL_FRAMES frames, returns the seconds
+// taken and adds up the instructions run
+double RunPool( micro16::ConsolePool &pool, uint64_t &instructions ) {
+    using Clock = std::chrono::steady_clock;
+
+    instructions = 0;
+    Clock::time_point start = Clock::now();
+    for ( int frame = 0; frame < POOL_FRAMES; frame++ ) {
+        pool.RunFrame();
+        for ( uint32_t i = 0; i < pool.Count(); i++ )
+            instructions += pool.Results()[i].instructions;
+    }
+    return std::chrono::duration<double>( Clock::now() - start ).count();
+}
+
+// Returns true if both pools' consoles are in the same state
+bool SamePools( micro16::ConsolePool &a, micro16::ConsolePool &b ) {
+    if (
+        memcmp(
+            a.Framebuffers(), b.Framebuffers(),
+            (size_t)a.Count() * micro16::SCREEN_PIXELS * sizeof( MiDi16::Color )
+        )
+    )
+        return false;
+
+    for ( uint32_t i = 0; i < a.Count(); i++ ) {
+        btp::CpuState stateA = a[i].cpu.GetState();
+        btp::CpuState stateB = b[i].cpu.GetState();
+        if (
+            memcmp( &stateA, &stateB, sizeof( stateA ) ) ||
+            memcmp( a[i].memory.data(), b[i].memory.data(), BOB3K_SIZE )
+        )
+            return false;
+    }
+    return true;
+}
+
+int main() {
+    // `loads` never halts, so every console does the same amount of work
+    const Program &program = programs[2];
+    cart::Cartridge cartridge;
+    cartridge.origin = program.origin;
+    cartridge.code.assign( program.code, program.code + program.size );
+
+    uint32_t cores = std::max( std::thread::hardware_concurrency(), 1u );
+
+    uint64_t instructions;
+    micro16::ConsolePool reference( POOL_CONSOLES, 1 );
+    reference.Insert( cartridge );
+    double baseline = RunPool( reference, instructions );
+
+    printf(
+        "%u consoles, %d frames, %u cores\n", POOL_CONSOLES, POOL_FRAMES, cores
+    );
+    for ( uint32_t threads = 1; ; threads *= 2 ) {
+        if ( threads > cores )
+            threads = std::max( cores, 2u ); // Always try stealing once
+
+        micro16::ConsolePool pool( POOL_CONSOLES, threads );
+        pool.Insert( cartridge );
+        double seconds = RunPool( pool, instructions );
+
+        if ( !SamePools( pool, reference ) ) {
+            printf( "%u threads: consoles differ from one thread\n", threads );
+            return 1;
+        }
+        printf(
+            "%3u threads %10.0f frames/s %8.2f MIPS %6.2fx\n",
+            threads, (double)POOL_CONSOLES * POOL_FRAMES / seconds,
+            instructions / seconds / 1e6, baseline / seconds
+        );
+
+        if ( threads >= cores && threads >= 2 )
+            break;
+    }
+    printf( "Pool check: passed\n" );
+
+    return 0;
+}
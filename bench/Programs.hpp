@@ -0,0 +1,103 @@
+/*
+* Copyright © 2025 Micro-16 Team
+* 
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the “Software”), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+* 
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+* 
+* THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#ifndef PROGRAMS_HPP
+#define PROGRAMS_HPP
+
+// Example programs shared by the benchmarks
+
+#include "stdint.h"
+#include "string.h"
+
+#include "btp6000/Btp.hpp"
+
+// A hand assembled example program
+struct Program {
+    const char *name;
+    uint16_t origin;
+    const uint8_t *code;
+    size_t size;
+};
+
+// btp6kasm/examples/test.asm
+// Fills the stack with BE EF until it overwrites itself and halts
+const uint8_t testCode[] = {
+    0xA0, 0x00, 0x02, // lda 0x200
+    0xAC,             // tass
+    0xA0, 0xBE, 0xEF, // lda 0xEFBE
+    0x50,             // .loop: pusha
+    0xC5, 0xFD,       // jmp .loop
+};
+
+// btp6kasm/examples/test2.asm
+// With a jump back to main appended, since it would run off into zeros
+const uint8_t test2Code[] = {
+    0xA0, 0x32, 0x00, // lda 50
+    0x90, 0x0C, 0x00, // ldy 12
+    0x81, 0x0C,       // .side_quest: ldx [bp+12]
+    0xB1, 0x36,       // ldb [bp+54]
+    0xA4,             // lda [[x]+y]
+    0xAA,             // main2: tax
+    0xA9,             // .side_quest: tab
+    0xC5, 0xF1,       // jmp main
+};
+
+// Nothing but loads in every addressing mode
+const uint8_t loadsCode[] = {
+    0xA0, 0x00, 0x20, // lda 0x2000
+    0xB0, 0x34, 0x12, // ldb 0x1234
+    0x80, 0x02, 0x00, // ldx 2
+    0x90, 0x04, 0x00, // ldy 4
+    0xA1,             // lda [bp+x]
+    0xB1, 0x10,       // ldb [bp+16]
+    0x81, 0x20,       // ldx [bp+32]
+    0x93,             // ldy [x]
+    0xA3,             // lda [x]
+    0xB3, 0x08,       // ldb [8]
+    0xA2,             // lda [[bp+x]+y]
+    0xC5, 0xE8,       // jmp main
+};
+
+const Program programs[] = {
+    { "test.asm",  0x2000, testCode,  sizeof( testCode ) },
+    { "test2.asm", 0x0000, test2Code, sizeof( test2Code ) },
+    { "loads",     0x1000, loadsCode, sizeof( loadsCode ) },
+};
+
+// Loads a program into memory and points the CPU at it
+void LoadProgram(
+    const Program &program,
+    Bob3k &memory,
+    btp::BetterThanPico &cpu
+) {
+    memset( memory.data(), 0, BOB3K_SIZE );
+    memcpy( memory.data() + program.origin, program.code, program.size );
+
+    cpu.Reset();
+    cpu.CS = program.origin >> 4;
+
+    // Every example ends in a loop, which would otherwise be fast-forwarded
+    // instead of timing the interpreter
+    cpu.SetIdleSkipping( false );
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,116 @@
+/*
+* Copyright © 2025 Micro-16 Team
+* 
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the “Software”), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+* 
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+* 
+* THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+// Checks that the rewind buffer walks back through exactly the states a
+// console went through, then reports how much memory it used and how long
+// pushing and rewinding a frame take.
+
+#include <chrono>
+#include <vector>
+
+#include "stdio.h"
+#include "stdint.h"
+#include "string.h"
+
+#include "btp6000/Btp.hpp"
+#include "btp6000/Rewind.hpp"
+#include "btp6000/SaveState.hpp"
+
+#include "Programs.hpp"
+
+#define REWIND_FRAMES   ( 60 * btp::FRAME_RATE )     // One minute
+#define KEYFRAME_FRAMES 60
+#define RUN_FRAMES      (int)( REWIND_FRAMES + 250 ) // Some get dropped
+#define CHECK_INTERVAL  7                            // Frames between states
+
+int main() {
+    using Clock = std::chrono::steady_clock;
+
+    static Bob3k memory;
+    btp::BetterThanPico cpu;
+    cpu.SetMemory( &memory );
+
+    for ( const Program &program : programs ) {
+        LoadProgram( program, memory, cpu );
+        btp::RewindBuffer rewind( REWIND_FRAMES, KEYFRAME_FRAMES );
+
+        // Run, keeping a save state every few frames to compare against
+        std::vector<std::vector<uint8_t>> states;
+        double pushSeconds = 0.0;
+        for ( int frame = 0; frame < RUN_FRAMES; frame++ ) {
+            cpu.RunFrame();
+
+            Clock::time_point start = Clock::now();
+            rewind.Push( cpu, memory );
+            pushSeconds +=
+                std::chrono::duration<double>( Clock::now() - start ).count();
+
+            if ( frame % CHECK_INTERVAL == 0 ) {
+                states.emplace_back( btp::STATE_SIZE );
+                btp::SaveState( cpu, memory, states.back().data() );
+            }
+        }
+        uint32_t kept = rewind.Count();
+        size_t size = rewind.Size();
+
+        // Walk all the way back
+        std::vector<uint8_t> state( btp::STATE_SIZE );
+        double rewindSeconds = 0.0;
+        int frame = RUN_FRAMES - 1, rewound = 0;
+        while ( true ) {
+            Clock::time_point start = Clock::now();
+            bool more = rewind.Rewind( cpu, memory );
+            rewindSeconds +=
+                std::chrono::duration<double>( Clock::now() - start ).count();
+            if ( !more )
+                break;
+
+            frame--;
+            rewound++;
+            if ( frame % CHECK_INTERVAL == 0 ) {
+                btp::SaveState( cpu, memory, state.data() );
+                if ( state != states[frame / CHECK_INTERVAL] ) {
+                    printf( "%s: frame %d differs\n", program.name, frame );
+                    return 1;
+                }
+            }
+        }
+        if ( rewound + 1 != (int)kept ) {
+            printf(
+                "%s: rewound %d of %u frames\n", program.name, rewound, kept
+            );
+            return 1;
+        }
+
+        printf(
+            "%-8s %u frames in %zu KiB, %.1f us per push, "
+            "%.1f us per rewind\n",
+            program.name, kept, size / 1024,
+            pushSeconds * 1e6 / RUN_FRAMES,
+            rewindSeconds * 1e6 / rewound
+        );
+    }
+    printf( "Rewind check: passed\n" );
+
+    return 0;
+}
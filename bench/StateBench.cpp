@@ -0,0 +1,101 @@
+/*
+* Copyright © 2025 Micro-16 Team
+* 
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the “Software”), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+* 
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+* 
+* THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+// Checks that save states restore a console exactly, in memory and through a
+// file, then measures how long a save and load round trip takes.
+
+#include <chrono>
+#include <vector>
+
+#include "stdio.h"
+#include "stdint.h"
+#include "string.h"
+
+#include "btp6000/Btp.hpp"
+#include "btp6000/SaveState.hpp"
+
+#include "Programs.hpp"
+
+#define ROUND_TRIPS 100000
+#define STATE_FILE  "../build/state.bin"
+
+// Runs a frame and saves the resulting state
+std::vector<uint8_t> RunAndSave( Bob3k &memory, btp::BetterThanPico &cpu ) {
+    std::vector<uint8_t> blob( btp::STATE_SIZE );
+    cpu.RunFrame();
+    btp::SaveState( cpu, memory, blob.data() );
+    return blob;
+}
+
+int main() {
+    static Bob3k memory;
+    btp::BetterThanPico cpu;
+    cpu.SetMemory( &memory );
+
+    // Running on from a restored state must end up where the first run did
+    for ( const Program &program : programs ) {
+        LoadProgram( program, memory, cpu );
+        cpu.RunFrame();
+
+        std::vector<uint8_t> start( btp::STATE_SIZE );
+        btp::SaveState( cpu, memory, start.data() );
+        std::vector<uint8_t> first = RunAndSave( memory, cpu );
+
+        btp::LoadState( cpu, memory, start.data(), start.size() );
+        std::vector<uint8_t> again = RunAndSave( memory, cpu );
+
+        btp::SaveStateFile( cpu, memory, STATE_FILE );
+        LoadProgram( program, memory, cpu );
+        if ( !btp::LoadStateFile( cpu, memory, STATE_FILE ) ) {
+            printf( "%s: could not load %s\n", program.name, STATE_FILE );
+            return 1;
+        }
+        std::vector<uint8_t> fromFile( btp::STATE_SIZE );
+        btp::SaveState( cpu, memory, fromFile.data() );
+
+        if ( first != again || first != fromFile ) {
+            printf( "%s: restored state differs\n", program.name );
+            return 1;
+        }
+    }
+    printf( "Restore check: passed\n" );
+
+    // Round trips
+    using Clock = std::chrono::steady_clock;
+    std::vector<uint8_t> blob( btp::STATE_SIZE );
+
+    Clock::time_point start = Clock::now();
+    for ( int i = 0; i < ROUND_TRIPS; i++ ) {
+        btp::SaveState( cpu, memory, blob.data() );
+        btp::LoadState( cpu, memory, blob.data(), blob.size() );
+    }
+    double seconds =
+        std::chrono::duration<double>( Clock::now() - start ).count();
+
+    printf(
+        "%zu byte state, %.2f us per save and load\n",
+        btp::STATE_SIZE, seconds * 1e6 / ROUND_TRIPS
+    );
+
+    return 0;
+}
@@ -0,0 +1,51 @@
+/*
+* Copyright © 2025 Micro-16 Team
+* 
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the “Software”), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+* 
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+* 
+* THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#include <iostream>
+#include <string>
+
+#include "stdint.h"
+
+
+#include "settings.hpp"
+#include "translator.hpp"
+
+int main( int argc, char **args ) {
+    // Create the settings object and parse arguments
+    Settings settings;
+    if ( !settings.Parse( argc, args ) )
+        return 1;
+
+    // Read the object
+    translator::Translator translator( &settings );
+    translator.Load();
+    if ( translator.error )
+        return 1;
+
+    // Write the C++
+    translator.Translate();
+    if ( translator.error )
+        return 1;
+
+
+    return 0;
+}
\ No newline at end of file
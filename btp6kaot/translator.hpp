@@ -0,0 +1,529 @@
+/*
+* Copyright © 2025 Micro-16 Team
+* 
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the “Software”), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+* 
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+* 
+* THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+#ifndef TRANSLATOR_HPP
+#define TRANSLATOR_HPP
+
+// Object reader and C++ generator
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "ctype.h"
+#include "stdio.h"
+#include "stdint.h"
+#include "string.h"
+
+#include "settings.hpp"
+#include "../src/btp6000/Btp.hpp"
+#include "../src/cartridge/Cartridge.hpp"
+
+// Translator namespace
+namespace translator {
+
+// An external label from the object header
+typedef cart::Label EntryPoint;
+
+// Reads a btp6kasm object and writes a C++ translation unit with one
+// function per external label
+class Translator {
+public:
+    bool error = false;
+
+    // Constructors
+    Translator() {}
+    Translator( Settings *settings ) : settings( settings ) {}
+
+    // Reads the object file and loads its code at the origin
+    void Load();
+
+    // Writes the translated code to the output file
+    void Translate();
+
+private:
+    Settings *settings;
+
+    Bob3k memory;
+    btp::DecodeCache decoder;
+
+    uint16_t origin   = 0x0000;
+    uint16_t codeSize = 0x0000;
+    std::vector<EntryPoint> entryPoints;
+
+    // Returns true if a whole instruction lies inside the code chunk
+    bool InCode( uint16_t address, uint8_t length ) {
+        return (uint16_t)( address - origin ) + length <= codeSize;
+    }
+
+    // Returns true if the instruction at an address can be translated
+    bool Translatable( uint16_t address );
+
+    // Returns the address execution continues at after an instruction, or -1
+    // if it leaves the translation (writing CS)
+    int Successor( uint16_t address );
+
+    // Collects every translatable instruction reachable from an entry point
+    std::set<uint16_t> Discover( uint16_t entry );
+
+    // Returns the cycles of the instructions from an address up to and
+    // including the next jmp, or up to where the translated code returns
+    uint32_t RunCycles( const std::set<uint16_t> &code, uint16_t address );
+
+    // Returns true if an instruction writes to memory
+    bool Writes( uint16_t address );
+
+    // Writes the function for one entry point and returns the other
+    // addresses it can be resumed at
+    std::vector<uint16_t> TranslateEntry(
+        std::ofstream &file,
+        const EntryPoint &entry
+    );
+
+    // Returns the statements of one instruction
+    std::string TranslateInstruction( uint16_t address );
+};
+
+// Formats a number as C++ hex
+std::string Hex( uint16_t value, int digits = 4 ) {
+    char text[8];
+    snprintf( text, sizeof( text ), "0x%0*X", digits, value );
+    return text;
+}
+
+// Name of the C++ label for an address
+std::string LabelName( uint16_t address ) {
+    return "L_" + Hex( address ).substr( 2 );
+}
+
+// Turns an assembly label into a C++ function name
+std::string FunctionName( const std::string &label ) {
+    std::string name = "Label_";
+    for ( char c : label )
+        name += isalnum( (unsigned char)c ) ? c : '_';
+    return name;
+}
+
+// Name of the local holding a family's register
+// Families: 0x8 X, 0x9 Y, 0xA A, 0xB B
+const char *RegisterName( uint8_t family ) {
+    switch ( family ) {
+        case 0x8: return "X";
+        case 0x9: return "Y";
+        case 0xA: return "A";
+        default:  return "B";
+    }
+}
+
+// Reads the object file and loads its code at the origin
+void Translator::Load() {
+    cart::Cartridge cartridge;
+    if ( !cartridge.Load( settings->inputFile ) ) {
+        error = true;
+        return;
+    }
+
+    origin = cartridge.origin;
+    codeSize = cartridge.code.size();
+    entryPoints = cartridge.labels;
+
+    // The decoder reads the code out of an otherwise empty memory
+    memset( memory.data(), 0, BOB3K_SIZE );
+    cartridge.Install( memory );
+    decoder.SetMemory( &memory );
+}
+
+// Returns true if the instruction at an address can be translated
+bool Translator::Translatable( uint16_t address ) {
+    const btp::DecodedInstruction &ins = decoder.Lookup( address );
+    if ( !InCode( address, ins.length ) )
+        return false;
+
+    uint8_t family = ins.opcode >> 4;
+    if ( family >= 0x8 && family <= 0xB )
+        return ( ins.opcode & 0xF ) != 0xF;
+
+    return
+        ( ins.opcode >= btp::INS_PUSHA && ins.opcode <= btp::INS_LEAVE ) ||
+        ins.opcode == btp::INS_JMP;
+}
+
+// Returns the address execution continues at after an instruction, or -1 if
+// it leaves the translation (writing CS)
+int Translator::Successor( uint16_t address ) {
+    const btp::DecodedInstruction &ins = decoder.Lookup( address );
+    uint16_t next = address + ins.length;
+
+    if ( ins.opcode == btp::INS_JMP )
+        return (uint16_t)( next + (int8_t)ins.imm8 );
+    if ( ins.opcode >= 0x80 && ( ins.opcode & 0xF ) == 0xD )
+        return -1;
+    return next;
+}
+
+// Collects every translatable instruction reachable from an entry point
+std::set<uint16_t> Translator::Discover( uint16_t entry ) {
+    std::set<uint16_t> code;
+    std::vector<uint16_t> pending = { entry };
+
+    while ( !pending.empty() ) {
+        uint16_t address = pending.back();
+        pending.pop_back();
+
+        if ( code.count( address ) || !Translatable( address ) )
+            continue;
+        code.insert( address );
+
+        int successor = Successor( address );
+        if ( successor != -1 )
+            pending.push_back( successor );
+    }
+
+    return code;
+}
+
+// Returns the cycles of the instructions from an address up to and including
+// the next jmp, or up to where the translated code returns
+uint32_t Translator::RunCycles(
+    const std::set<uint16_t> &code,
+    uint16_t address
+) {
+    uint32_t cycles = 0;
+    while ( code.count( address ) ) {
+        const btp::DecodedInstruction &ins = decoder.Lookup( address );
+        cycles += ins.cycles;
+
+        int successor = Successor( address );
+        if ( ins.opcode == btp::INS_JMP || successor == -1 )
+            break;
+        address = successor;
+    }
+    return cycles;
+}
+
+// Returns true if an instruction writes to memory
+bool Translator::Writes( uint16_t address ) {
+    const btp::DecodedInstruction &ins = decoder.Lookup( address );
+    uint8_t family = ins.opcode >> 4;
+    uint8_t mode = ins.opcode & 0xF;
+
+    if ( family >= 0x8 && family <= 0xB )
+        return mode >= 0x5 && mode <= 0x8;
+    return ins.opcode == btp::INS_ENTER || (
+        ins.opcode >= btp::INS_PUSHA && ins.opcode <= btp::INS_POPY &&
+        !( ins.opcode & 1 )
+    );
+}
+
+// Writes the translated code to the output file
+void Translator::Translate() {
+    std::ofstream file( settings->outputFile );
+    if ( !file.is_open() ) {
+        std::cout << "File \"" << settings->outputFile << "\" either does "
+            "not exist or cannot be opened.\n";
+        error = true;
+        return;
+    }
+
+    file <<
+        "// Generated by btp6kaot from " << settings->inputFile << "\n"
+        "\n"
+        "#include \"btp6000/Aot.hpp\"\n"
+        "\n"
+        "using namespace btp;\n";
+
+    // Labels come first so that they win over resume points of other labels
+    // Every entry carries the range of code its function was translated from
+    std::vector<EntryPoint> translated;
+    std::vector<std::string> functions;
+    std::vector<std::string> ranges;
+    std::vector<EntryPoint> resumes;
+    std::vector<size_t> resumeFunctions;
+    for ( const EntryPoint &entry : entryPoints ) {
+        if ( !Translatable( entry.address ) ) {
+            std::cout << "WARNING: Label \"" << entry.name << "\" does not "
+                "start with a translatable instruction, skipping it.\n";
+            continue;
+        }
+
+        std::set<uint16_t> code = Discover( entry.address );
+        uint16_t last = *code.rbegin();
+        last += decoder.Lookup( last ).length - 1;
+
+        translated.push_back( entry );
+        functions.push_back( FunctionName( entry.name ) );
+        ranges.push_back( Hex( *code.begin() ) + ", " + Hex( last ) );
+        for ( uint16_t address : TranslateEntry( file, entry ) ) {
+            resumes.push_back( {
+                entry.name + "+" + Hex( address - entry.address ),
+                address
+            } );
+            resumeFunctions.push_back( functions.size() - 1 );
+        }
+    }
+
+    std::set<uint16_t> addresses;
+    for ( const EntryPoint &entry : translated )
+        addresses.insert( entry.address );
+    for ( size_t i = 0; i < resumes.size(); i++ ) {
+        if ( addresses.insert( resumes[i].address ).second ) {
+            std::string function = functions[resumeFunctions[i]];
+            std::string range = ranges[resumeFunctions[i]];
+            translated.push_back( resumes[i] );
+            functions.push_back( function );
+            ranges.push_back( range );
+        }
+    }
+
+    file << "\n"
+        "// Translated labels and the loops inside them\n"
+        "const AotEntry btp::aotEntries[] = {\n";
+    for ( size_t i = 0; i < translated.size(); i++ ) {
+        file << "    { \"" << translated[i].name << "\", "
+            << Hex( translated[i].address ) << ", " << ranges[i] << ", "
+            << functions[i] << " },\n";
+    }
+    if ( translated.empty() )
+        file << "    { nullptr, 0x0000, 0x0000, 0x0000, nullptr },\n";
+    file << "};\n"
+        "const int btp::aotEntryCount = " << translated.size() << ";\n";
+}
+
+// Writes the function for one entry point and returns the other addresses
+// it can be resumed at
+std::vector<uint16_t> Translator::TranslateEntry(
+    std::ofstream &file,
+    const EntryPoint &entry
+) {
+    std::set<uint16_t> code = Discover( entry.address );
+
+    // Running out of cycles before a jump's target leaves the function there,
+    // so the function must also be able to start there
+    std::vector<uint16_t> resumes;
+    for ( uint16_t address : code ) {
+        int successor = Successor( address );
+        if ( decoder.Lookup( address ).opcode == btp::INS_JMP &&
+            code.count( successor ) && successor != entry.address &&
+            std::find( resumes.begin(), resumes.end(), successor ) ==
+            resumes.end() )
+            resumes.push_back( successor );
+    }
+
+    // Instructions are written in address order, so only the entry points,
+    // jump targets and fall throughs into code that is not written next
+    // need C++ labels
+    std::set<uint16_t> labels( resumes.begin(), resumes.end() );
+    if ( *code.begin() != entry.address || !resumes.empty() )
+        labels.insert( entry.address );
+    for ( auto it = code.begin(); it != code.end(); it++ ) {
+        int successor = Successor( *it );
+        auto following = std::next( it );
+        bool jump = decoder.Lookup( *it ).opcode == btp::INS_JMP;
+
+        if ( successor != -1 && code.count( successor ) &&
+            ( jump || following == code.end() || *following != successor ) )
+            labels.insert( successor );
+    }
+
+    // Registers live in locals so that the compiler can keep them in host
+    // registers. They are written back at the single exit.
+    file << "\n"
+        "// " << entry.name << " (" << Hex( entry.address ) << ")\n"
+        "static void " << FunctionName( entry.name ) << "(\n"
+        "    BetterThanPico &cpu,\n"
+        "    Bob3k &memory,\n"
+        "    RunResult &result,\n"
+        "    const uint32_t &limit\n"
+        ") {\n"
+        "    uint16_t A = cpu.A.value, B = cpu.B.value, X = cpu.X, Y = cpu.Y;\n"
+        "    uint16_t SP = cpu.SP, BP = cpu.BP;\n"
+        "    uint16_t SS = cpu.SS, CS = cpu.CS, DS = cpu.DS;\n"
+        "    Flags flags = cpu.GetFlags();\n"
+        "    const uint16_t ip = cpu.IP;\n"
+        "    const uint16_t start = aot::Linear( CS, ip );\n"
+        "    uint16_t next = start; // Linear address to resume at\n"
+        "    uint32_t cycles = 0, instructions = 0;\n";
+    if ( !resumes.empty() ) {
+        file << "\n    switch ( start ) {\n";
+        for ( uint16_t address : resumes ) {
+            file << "        case " << Hex( address ) << ": goto "
+                << LabelName( address ) << ";\n";
+        }
+        file << "        default: goto " << LabelName( entry.address )
+            << ";\n"
+            "    }\n";
+    }
+    else if ( *code.begin() != entry.address )
+        file << "\n    goto " << LabelName( entry.address ) << ";\n";
+
+    for ( auto it = code.begin(); it != code.end(); it++ ) {
+        uint16_t address = *it;
+        const btp::DecodedInstruction &ins = decoder.Lookup( address );
+
+        // The interpreter stops at the first instruction that starts at or
+        // past the limit. Running up to the next jump only when that ends
+        // below the limit stops at the same instruction, since the
+        // interpreter finishes the rest.
+        file << "\n";
+        if ( labels.count( address ) )
+            file << LabelName( address ) << ":\n";
+        if ( labels.count( address ) || address == entry.address ) {
+            file << "    if ( result.cycles + cycles + "
+                << RunCycles( code, address ) << " >= limit ) {\n"
+                "        next = " << Hex( address ) << "; goto exit;\n"
+                "    }\n";
+        }
+
+        file << "    // " << Hex( address ) << ":";
+        for ( int i = 0; i < ins.length; i++ )
+            file << " " << Hex( memory.Read( address + i ), 2 ).substr( 2 );
+        file << "\n"
+            "    cycles += " << (int)ins.cycles << "; instructions++;\n"
+            << TranslateInstruction( address );
+
+        // A write to the interrupt page or to translated code lowers the
+        // limit, which ends the slice right after it like in the interpreter
+        uint16_t following = address + ins.length;
+        if ( Writes( address ) ) {
+            file << "    if ( result.cycles + cycles >= limit ) {\n"
+                "        next = " << Hex( following ) << "; goto exit;\n"
+                "    }\n";
+        }
+
+        // Leave the function wherever the next instruction was not translated
+        int successor = Successor( address );
+        auto nextWritten = std::next( it );
+        if ( successor == -1 )
+            successor = following;
+        else if (
+            ins.opcode != btp::INS_JMP && nextWritten != code.end() &&
+            *nextWritten == successor
+        )
+            continue;
+
+        if ( code.count( successor ) && Successor( address ) != -1 )
+            file << "    goto " << LabelName( successor ) << ";\n";
+        else {
+            file << "    next = " << Hex( successor ) << "; goto exit;\n";
+        }
+    }
+
+    file << "\n"
+        "exit:\n"
+        "    cpu.A.value = A; cpu.B.value = B; cpu.X = X; cpu.Y = Y;\n"
+        "    cpu.SP = SP; cpu.BP = BP;\n"
+        "    cpu.SS = SS; cpu.CS = CS; cpu.DS = DS;\n"
+        "    cpu.SetFlags( flags );\n"
+        "    cpu.IP = ip + (uint16_t)( next - start );\n"
+        "    result.cycles += cycles;\n"
+        "    result.instructions += instructions;\n"
+        "}\n";
+
+    return resumes;
+}
+
+// Returns the statements of one instruction
+std::string Translator::TranslateInstruction( uint16_t address ) {
+    const btp::DecodedInstruction &ins = decoder.Lookup( address );
+    uint8_t family = ins.opcode >> 4;
+    uint8_t mode   = ins.opcode & 0xF;
+
+    if ( family < 0x8 || family > 0xB ) {
+        // Stack operations, JMP is handled by the caller
+        const char *pushed[] = { "A", "B", "X", "Y" };
+        std::string reg = pushed[( ins.opcode - btp::INS_PUSHA ) / 2 % 4];
+        std::string push =
+            "    SP -= 2; memory.Write16( aot::Linear( SS, SP ), ";
+        std::string pop =
+            " = memory.Read16( aot::Linear( SS, SP ) ); SP += 2;\n";
+
+        switch ( ins.opcode ) {
+            case btp::INS_PUSHA: case btp::INS_PUSHB:
+            case btp::INS_PUSHX: case btp::INS_PUSHY:
+                return push + reg + " );\n";
+            case btp::INS_POPA: case btp::INS_POPB:
+            case btp::INS_POPX: case btp::INS_POPY:
+                return "    " + reg + pop;
+            case btp::INS_ENTER:
+                return push + "BP );\n    BP = SP;\n";
+            case btp::INS_LEAVE:
+                return "    SP = BP;\n    BP" + pop;
+            default:
+                return "";
+        }
+    }
+
+    std::string reg = RegisterName( family );
+
+    // A and Y index with X, B and X with an immediate
+    std::string index = ( family == 0xA || family == 0x9 ) ?
+        "X" : Hex( ins.imm8, 2 );
+    // A and X point with Y, B and Y with an immediate
+    std::string pointer = ( family == 0xA || family == 0x8 ) ?
+        "Y" : Hex( ins.imm16 );
+
+    bool stack = mode == 0x1 || mode == 0x2 || mode == 0x5 || mode == 0x6;
+    std::string location = stack ?
+        "aot::Linear( SS, BP + " + index + " )" :
+        "aot::Linear( DS, " + index + " )";
+    std::string pointed = "aot::Linear(\n"
+        "        SS, memory.Read16( " + location + " ) + " + pointer + "\n"
+        "    )";
+
+    switch ( mode ) {
+        case 0x0:
+            return "    " + reg + " = aot::Load( flags, " + Hex( ins.imm16 ) +
+                " );\n";
+        case 0x1: case 0x3:
+            return "    " + reg + " = aot::Load( flags, memory.Read16( " +
+                location + " ) );\n";
+        case 0x2: case 0x4:
+            return "    " + reg + " = aot::Load( flags, memory.Read16( " +
+                pointed + " ) );\n";
+        case 0x5: case 0x7:
+            return "    memory.Write16( " + location + ", " + reg + " );\n";
+        case 0x6: case 0x8:
+            return "    memory.Write16( " + pointed + ", " + reg + " );\n";
+        default: {
+            // The other three registers in order, then SS, CS, DS
+            const char *registers[] = { "A", "B", "X", "Y" };
+            std::vector<std::string> targets;
+            for ( const char *other : registers ) {
+                if ( reg != other )
+                    targets.push_back( other );
+            }
+            targets.push_back( "SS" );
+            targets.push_back( "CS" );
+            targets.push_back( "DS" );
+
+            return "    " + targets[mode - 0x9] + " = " + reg + ";\n";
+        }
+    }
+}
+
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,60 @@
+.org 1000h
+.data 3000h
+
+extern main
+extern vblank
+extern timer
+
+; Installs a vblank and a timer handler, starts the timer and shuffles words
+; through the stack and the data segment between interrupts
+main:
+    lda 0x0100      ; CS of both handlers
+    ldx 0x3F00
+    sta [x]
+    ldx 0x3F04
+    sta [x]
+    lda 0x0037      ; IP of vblank
+    ldx 0x3F02
+    sta [x]
+    lda 0x0048      ; IP of timer
+    ldx 0x3F06
+    sta [x]
+    lda 1000        ; Timer period
+    ldx 0x3F40
+    sta [x]
+    lda 0x0200
+    tass            ; Stack at 2000h
+    lda 0x0300
+    tads            ; Data at 3000h
+    ldx 0
+    lda 0x1234
+
+.loop:
+    pusha
+    popb
+    stb [6]
+    lda [x]
+    ldb [6]
+    jmp .loop
+
+; Swaps the first two words of data
+vblank:
+    pusha
+    pushb
+    ldb [0]
+    ldx 2
+    lda [x]
+    stb [2]
+    ldx 0
+    sta [x]
+    popb
+    popa
+    rti
+
+; Moves the second word of data to the third
+timer:
+    pusha
+    ldb [2]
+    stb [4]
+    popa
+    rti
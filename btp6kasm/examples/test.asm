@@ -1,6 +1,7 @@
 .org 2000h
 .data 3000h
 
+extern main
 main:
     lda 0x200
     tass       ; Stack Segment = 0x200
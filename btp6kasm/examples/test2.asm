@@ -1,5 +1,6 @@
 .org 0000h
 
+extern main
 main:
     lda 50
     ldy 12
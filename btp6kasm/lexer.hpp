@@ -66,7 +66,7 @@ std::vector<std::string> instructions = {
     "enter", "leave", "call", "ret",
     "tssb", "tcsb", "tdsb",
     "cmp", "je", "jne", "jg", "jge", "jmp", "ljmp",
-    "int", "rti",
+    "int", "rti", "wai",
 };
 
 // Registers
@@ -137,6 +137,11 @@ const std::unordered_map<std::string, Info> instructions = {
     // Jump stuff
     { "jmp", { INS_JMP, IM8 } },
 
+    // Interrupts
+    { "int", { INS_INT, IM8 } },
+    { "rti", { INS_RTI, NONE } },
+    { "wai", { INS_WAI, NONE } },
+
 };
 
 // Returns the addressing mode of an instruction given its token
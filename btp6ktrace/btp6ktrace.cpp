@@ -0,0 +1,211 @@
+/*
+* Copyright © 2025 Micro-16 Team
+* 
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the “Software”), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+* 
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+* 
+* THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+// Turns a binary trace written by btp::Tracer::Dump() into text, one
+// instruction per line.
+
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "stdio.h"
+#include "stdint.h"
+#include "string.h"
+
+#include "../src/btp6000/Btp.hpp"
+
+const char helpMessage[] =
+"Better Than Pico 6000 Trace Decoder\n"
+"Arguments:\n"
+"    -h - Help message\n"
+"    -o - Output text file (default: standard output)\n"
+"    default - Input trace file\n"
+"\n\nExample:\n"
+"    btp6ktrace trace.bin -o trace.txt\n";
+
+// Names of the instructions that are not loads or stores
+const char *OtherName( uint8_t opcode ) {
+    switch ( opcode ) {
+        case btp::INS_TAB:   return "tab";
+        case btp::INS_TAX:   return "tax";
+        case btp::INS_TAY:   return "tay";
+        case btp::INS_TASS:  return "tass";
+        case btp::INS_TACS:  return "tacs";
+        case btp::INS_TADS:  return "tads";
+        case btp::INS_TBA:   return "tba";
+        case btp::INS_TBX:   return "tbx";
+        case btp::INS_TBY:   return "tby";
+        case btp::INS_TBSS:  return "tbss";
+        case btp::INS_TBCS:  return "tbcs";
+        case btp::INS_TBDS:  return "tbds";
+        case btp::INS_TXA:   return "txa";
+        case btp::INS_TXB:   return "txb";
+        case btp::INS_TXY:   return "txy";
+        case btp::INS_TXSS:  return "txss";
+        case btp::INS_TXCS:  return "txcs";
+        case btp::INS_TXDS:  return "txds";
+        case btp::INS_TYA:   return "tya";
+        case btp::INS_TYB:   return "tyb";
+        case btp::INS_TYX:   return "tyx";
+        case btp::INS_TYSS:  return "tyss";
+        case btp::INS_TYCS:  return "tycs";
+        case btp::INS_TYDS:  return "tyds";
+        case btp::INS_PUSHA: return "pusha";
+        case btp::INS_POPA:  return "popa";
+        case btp::INS_PUSHB: return "pushb";
+        case btp::INS_POPB:  return "popb";
+        case btp::INS_PUSHX: return "pushx";
+        case btp::INS_POPX:  return "popx";
+        case btp::INS_PUSHY: return "pushy";
+        case btp::INS_POPY:  return "popy";
+        case btp::INS_ENTER: return "enter";
+        case btp::INS_LEAVE: return "leave";
+        case btp::INS_JMP:   return "jmp n";
+        case btp::INS_INT:   return "int n";
+        case btp::INS_RTI:   return "rti";
+        case btp::INS_WAI:   return "wai";
+        default:             return "???";
+    }
+}
+
+// Returns the assembly of an opcode, with `n` for immediates since the trace
+// does not keep them
+std::string Disassemble( uint8_t opcode ) {
+    const char registerNames[] = "abxy";
+    const char *sources[] = { "x", "y", "n", "n" }; // By OperandSource
+
+    for ( int reg = 0; reg < btp::REG_COUNT; reg++ ) {
+        const btp::RegisterLayout &layout = btp::registerLayouts[reg];
+
+        int mode = opcode - layout.base;
+        bool store = false;
+        if ( mode > btp::MODE_DPO ) {
+            mode -= 4;
+            store = true;
+        }
+        if ( mode < btp::MODE_IM || mode > btp::MODE_DPO )
+            continue;
+
+        std::string text = store ? "st" : "ld";
+        text += registerNames[reg];
+        if ( mode == btp::MODE_IM )
+            return text + " n";
+
+        std::string address = btp::IsStackMode( mode ) ? "bp+" : "";
+        address += sources[layout.offset];
+        if ( btp::IsPointerMode( mode ) )
+            return text + " [[" + address + "]+" +
+                sources[layout.pointer] + "]";
+        return text + " [" + address + "]";
+    }
+
+    return OtherName( opcode );
+}
+
+// Prints the set flags as letters
+std::string FlagText( uint8_t value ) {
+    btp::Flags flags;
+    flags.value = value;
+
+    std::string text = "-----";
+    if ( flags.C ) text[0] = 'C';
+    if ( flags.Z ) text[1] = 'Z';
+    if ( flags.V ) text[2] = 'V';
+    if ( flags.N ) text[3] = 'N';
+    if ( flags.I ) text[4] = 'I';
+    return text;
+}
+
+int main( int argc, char **args ) {
+    std::string inputFile, outputFile;
+    for ( int i = 1; i < argc; i++ ) {
+        std::string arg = args[i];
+        if ( arg == "-o" && i + 1 < argc )
+            outputFile = args[++i];
+        else if ( arg[0] == '-' ) {
+            std::cout << helpMessage;
+            return 1;
+        }
+        else
+            inputFile = arg;
+    }
+    if ( inputFile.empty() ) {
+        std::cout << helpMessage;
+        return 1;
+    }
+
+    std::ifstream file( inputFile, std::ios::binary );
+    if ( !file ) {
+        std::cout << "Could not open \"" << inputFile << "\"!\n";
+        return 1;
+    }
+
+    btp::TraceHeader header;
+    file.read( (char*)&header, sizeof( header ) );
+    if (
+        !file ||
+        memcmp( header.magic, BTP_TRACE_MAGIC, sizeof( header.magic ) ) != 0
+    ) {
+        std::cout << "\"" << inputFile << "\" is not a trace file!\n";
+        return 1;
+    }
+    if (
+        header.version != BTP_TRACE_VERSION ||
+        header.recordSize != sizeof( btp::TraceRecord )
+    ) {
+        std::cout << "Unsupported trace version " << header.version << "!\n";
+        return 1;
+    }
+
+    FILE *output = stdout;
+    if ( !outputFile.empty() ) {
+        output = fopen( outputFile.c_str(), "w" );
+        if ( output == nullptr ) {
+            std::cout << "Could not open \"" << outputFile << "\"!\n";
+            return 1;
+        }
+    }
+
+    btp::TraceRecord record;
+    for ( uint32_t i = 0; i < header.count; i++ ) {
+        file.read( (char*)&record, sizeof( record ) );
+        if ( !file ) {
+            std::cout << "Trace ends after " << i << " records!\n";
+            break;
+        }
+
+        fprintf(
+            output,
+            "%04X:%04X  %02X  %-14s A=%04X B=%04X X=%04X Y=%04X SP=%04X %s\n",
+            record.CS, record.IP, record.opcode,
+            Disassemble( record.opcode ).c_str(),
+            record.A, record.B, record.X, record.Y, record.SP,
+            FlagText( record.flags ).c_str()
+        );
+    }
+
+    if ( output != stdout )
+        fclose( output );
+
+    return 0;
+}
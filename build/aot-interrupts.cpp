@@ -0,0 +1,312 @@
+// Generated by btp6kaot from ../build/aot-interrupts.o
+
+#include "btp6000/Aot.hpp"
+
+using namespace btp;
+
+// timer (0x1048)
+static void Label_timer(
+    BetterThanPico &cpu,
+    Bob3k &memory,
+    RunResult &result,
+    const uint32_t &limit
+) {
+    uint16_t A = cpu.A.value, B = cpu.B.value, X = cpu.X, Y = cpu.Y;
+    uint16_t SP = cpu.SP, BP = cpu.BP;
+    uint16_t SS = cpu.SS, CS = cpu.CS, DS = cpu.DS;
+    Flags flags = cpu.GetFlags();
+    const uint16_t ip = cpu.IP;
+    const uint16_t start = aot::Linear( CS, ip );
+    uint16_t next = start; // Linear address to resume at
+    uint32_t cycles = 0, instructions = 0;
+
+    if ( result.cycles + cycles + 14 >= limit ) {
+        next = 0x1048; goto exit;
+    }
+    // 0x1048: 50
+    cycles += 3; instructions++;
+    SP -= 2; memory.Write16( aot::Linear( SS, SP ), A );
+    if ( result.cycles + cycles >= limit ) {
+        next = 0x1049; goto exit;
+    }
+
+    // 0x1049: B3 02
+    cycles += 4; instructions++;
+    B = aot::Load( flags, memory.Read16( aot::Linear( DS, 0x02 ) ) );
+
+    // 0x104B: B7 04
+    cycles += 4; instructions++;
+    memory.Write16( aot::Linear( DS, 0x04 ), B );
+    if ( result.cycles + cycles >= limit ) {
+        next = 0x104D; goto exit;
+    }
+
+    // 0x104D: 51
+    cycles += 3; instructions++;
+    A = memory.Read16( aot::Linear( SS, SP ) ); SP += 2;
+    next = 0x104E; goto exit;
+
+exit:
+    cpu.A.value = A; cpu.B.value = B; cpu.X = X; cpu.Y = Y;
+    cpu.SP = SP; cpu.BP = BP;
+    cpu.SS = SS; cpu.CS = CS; cpu.DS = DS;
+    cpu.SetFlags( flags );
+    cpu.IP = ip + (uint16_t)( next - start );
+    result.cycles += cycles;
+    result.instructions += instructions;
+}
+
+// vblank (0x1037)
+static void Label_vblank(
+    BetterThanPico &cpu,
+    Bob3k &memory,
+    RunResult &result,
+    const uint32_t &limit
+) {
+    uint16_t A = cpu.A.value, B = cpu.B.value, X = cpu.X, Y = cpu.Y;
+    uint16_t SP = cpu.SP, BP = cpu.BP;
+    uint16_t SS = cpu.SS, CS = cpu.CS, DS = cpu.DS;
+    Flags flags = cpu.GetFlags();
+    const uint16_t ip = cpu.IP;
+    const uint16_t start = aot::Linear( CS, ip );
+    uint16_t next = start; // Linear address to resume at
+    uint32_t cycles = 0, instructions = 0;
+
+    if ( result.cycles + cycles + 32 >= limit ) {
+        next = 0x1037; goto exit;
+    }
+    // 0x1037: 50
+    cycles += 3; instructions++;
+    SP -= 2; memory.Write16( aot::Linear( SS, SP ), A );
+    if ( result.cycles + cycles >= limit ) {
+        next = 0x1038; goto exit;
+    }
+
+    // 0x1038: 52
+    cycles += 3; instructions++;
+    SP -= 2; memory.Write16( aot::Linear( SS, SP ), B );
+    if ( result.cycles + cycles >= limit ) {
+        next = 0x1039; goto exit;
+    }
+
+    // 0x1039: B3 00
+    cycles += 4; instructions++;
+    B = aot::Load( flags, memory.Read16( aot::Linear( DS, 0x00 ) ) );
+
+    // 0x103B: 80 02 00
+    cycles += 3; instructions++;
+    X = aot::Load( flags, 0x0002 );
+
+    // 0x103E: A3
+    cycles += 3; instructions++;
+    A = aot::Load( flags, memory.Read16( aot::Linear( DS, X ) ) );
+
+    // 0x103F: B7 02
+    cycles += 4; instructions++;
+    memory.Write16( aot::Linear( DS, 0x02 ), B );
+    if ( result.cycles + cycles >= limit ) {
+        next = 0x1041; goto exit;
+    }
+
+    // 0x1041: 80 00 00
+    cycles += 3; instructions++;
+    X = aot::Load( flags, 0x0000 );
+
+    // 0x1044: A7
+    cycles += 3; instructions++;
+    memory.Write16( aot::Linear( DS, X ), A );
+    if ( result.cycles + cycles >= limit ) {
+        next = 0x1045; goto exit;
+    }
+
+    // 0x1045: 53
+    cycles += 3; instructions++;
+    B = memory.Read16( aot::Linear( SS, SP ) ); SP += 2;
+
+    // 0x1046: 51
+    cycles += 3; instructions++;
+    A = memory.Read16( aot::Linear( SS, SP ) ); SP += 2;
+    next = 0x1047; goto exit;
+
+exit:
+    cpu.A.value = A; cpu.B.value = B; cpu.X = X; cpu.Y = Y;
+    cpu.SP = SP; cpu.BP = BP;
+    cpu.SS = SS; cpu.CS = CS; cpu.DS = DS;
+    cpu.SetFlags( flags );
+    cpu.IP = ip + (uint16_t)( next - start );
+    result.cycles += cycles;
+    result.instructions += instructions;
+}
+
+// main (0x1000)
+static void Label_main(
+    BetterThanPico &cpu,
+    Bob3k &memory,
+    RunResult &result,
+    const uint32_t &limit
+) {
+    uint16_t A = cpu.A.value, B = cpu.B.value, X = cpu.X, Y = cpu.Y;
+    uint16_t SP = cpu.SP, BP = cpu.BP;
+    uint16_t SS = cpu.SS, CS = cpu.CS, DS = cpu.DS;
+    Flags flags = cpu.GetFlags();
+    const uint16_t ip = cpu.IP;
+    const uint16_t start = aot::Linear( CS, ip );
+    uint16_t next = start; // Linear address to resume at
+    uint32_t cycles = 0, instructions = 0;
+
+    switch ( start ) {
+        case 0x102E: goto L_102E;
+        default: goto L_1000;
+    }
+
+L_1000:
+    if ( result.cycles + cycles + 75 >= limit ) {
+        next = 0x1000; goto exit;
+    }
+    // 0x1000: A0 00 01
+    cycles += 3; instructions++;
+    A = aot::Load( flags, 0x0100 );
+
+    // 0x1003: 80 00 3F
+    cycles += 3; instructions++;
+    X = aot::Load( flags, 0x3F00 );
+
+    // 0x1006: A7
+    cycles += 3; instructions++;
+    memory.Write16( aot::Linear( DS, X ), A );
+    if ( result.cycles + cycles >= limit ) {
+        next = 0x1007; goto exit;
+    }
+
+    // 0x1007: 80 04 3F
+    cycles += 3; instructions++;
+    X = aot::Load( flags, 0x3F04 );
+
+    // 0x100A: A7
+    cycles += 3; instructions++;
+    memory.Write16( aot::Linear( DS, X ), A );
+    if ( result.cycles + cycles >= limit ) {
+        next = 0x100B; goto exit;
+    }
+
+    // 0x100B: A0 37 00
+    cycles += 3; instructions++;
+    A = aot::Load( flags, 0x0037 );
+
+    // 0x100E: 80 02 3F
+    cycles += 3; instructions++;
+    X = aot::Load( flags, 0x3F02 );
+
+    // 0x1011: A7
+    cycles += 3; instructions++;
+    memory.Write16( aot::Linear( DS, X ), A );
+    if ( result.cycles + cycles >= limit ) {
+        next = 0x1012; goto exit;
+    }
+
+    // 0x1012: A0 48 00
+    cycles += 3; instructions++;
+    A = aot::Load( flags, 0x0048 );
+
+    // 0x1015: 80 06 3F
+    cycles += 3; instructions++;
+    X = aot::Load( flags, 0x3F06 );
+
+    // 0x1018: A7
+    cycles += 3; instructions++;
+    memory.Write16( aot::Linear( DS, X ), A );
+    if ( result.cycles + cycles >= limit ) {
+        next = 0x1019; goto exit;
+    }
+
+    // 0x1019: A0 E8 03
+    cycles += 3; instructions++;
+    A = aot::Load( flags, 0x03E8 );
+
+    // 0x101C: 80 40 3F
+    cycles += 3; instructions++;
+    X = aot::Load( flags, 0x3F40 );
+
+    // 0x101F: A7
+    cycles += 3; instructions++;
+    memory.Write16( aot::Linear( DS, X ), A );
+    if ( result.cycles + cycles >= limit ) {
+        next = 0x1020; goto exit;
+    }
+
+    // 0x1020: A0 00 02
+    cycles += 3; instructions++;
+    A = aot::Load( flags, 0x0200 );
+
+    // 0x1023: AC
+    cycles += 1; instructions++;
+    SS = A;
+
+    // 0x1024: A0 00 03
+    cycles += 3; instructions++;
+    A = aot::Load( flags, 0x0300 );
+
+    // 0x1027: AE
+    cycles += 1; instructions++;
+    DS = A;
+
+    // 0x1028: 80 00 00
+    cycles += 3; instructions++;
+    X = aot::Load( flags, 0x0000 );
+
+    // 0x102B: A0 34 12
+    cycles += 3; instructions++;
+    A = aot::Load( flags, 0x1234 );
+
+L_102E:
+    if ( result.cycles + cycles + 19 >= limit ) {
+        next = 0x102E; goto exit;
+    }
+    // 0x102E: 50
+    cycles += 3; instructions++;
+    SP -= 2; memory.Write16( aot::Linear( SS, SP ), A );
+    if ( result.cycles + cycles >= limit ) {
+        next = 0x102F; goto exit;
+    }
+
+    // 0x102F: 53
+    cycles += 3; instructions++;
+    B = memory.Read16( aot::Linear( SS, SP ) ); SP += 2;
+
+    // 0x1030: B7 06
+    cycles += 4; instructions++;
+    memory.Write16( aot::Linear( DS, 0x06 ), B );
+    if ( result.cycles + cycles >= limit ) {
+        next = 0x1032; goto exit;
+    }
+
+    // 0x1032: A3
+    cycles += 3; instructions++;
+    A = aot::Load( flags, memory.Read16( aot::Linear( DS, X ) ) );
+
+    // 0x1033: B3 06
+    cycles += 4; instructions++;
+    B = aot::Load( flags, memory.Read16( aot::Linear( DS, 0x06 ) ) );
+
+    // 0x1035: C5 F7
+    cycles += 2; instructions++;
+    goto L_102E;
+
+exit:
+    cpu.A.value = A; cpu.B.value = B; cpu.X = X; cpu.Y = Y;
+    cpu.SP = SP; cpu.BP = BP;
+    cpu.SS = SS; cpu.CS = CS; cpu.DS = DS;
+    cpu.SetFlags( flags );
+    cpu.IP = ip + (uint16_t)( next - start );
+    result.cycles += cycles;
+    result.instructions += instructions;
+}
+
+// Translated labels and the loops inside them
+const AotEntry btp::aotEntries[] = {
+    { "timer", 0x1048, 0x1048, 0x104D, Label_timer },
+    { "vblank", 0x1037, 0x1037, 0x1046, Label_vblank },
+    { "main", 0x1000, 0x1000, 0x1036, Label_main },
+    { "main+0x002E", 0x102E, 0x1000, 0x1036, Label_main },
+};
+const int btp::aotEntryCount = 4;
@@ -0,0 +1,74 @@
+// Generated by btp6kaot from ../build/aot-test.o
+
+#include "btp6000/Aot.hpp"
+
+using namespace btp;
+
+// main (0x2000)
+static void Label_main(
+    BetterThanPico &cpu,
+    Bob3k &memory,
+    RunResult &result,
+    const uint32_t &limit
+) {
+    uint16_t A = cpu.A.value, B = cpu.B.value, X = cpu.X, Y = cpu.Y;
+    uint16_t SP = cpu.SP, BP = cpu.BP;
+    uint16_t SS = cpu.SS, CS = cpu.CS, DS = cpu.DS;
+    Flags flags = cpu.GetFlags();
+    const uint16_t ip = cpu.IP;
+    const uint16_t start = aot::Linear( CS, ip );
+    uint16_t next = start; // Linear address to resume at
+    uint32_t cycles = 0, instructions = 0;
+
+    switch ( start ) {
+        case 0x2007: goto L_2007;
+        default: goto L_2000;
+    }
+
+L_2000:
+    if ( result.cycles + cycles + 12 >= limit ) {
+        next = 0x2000; goto exit;
+    }
+    // 0x2000: A0 00 02
+    cycles += 3; instructions++;
+    A = aot::Load( flags, 0x0200 );
+
+    // 0x2003: AC
+    cycles += 1; instructions++;
+    SS = A;
+
+    // 0x2004: A0 BE EF
+    cycles += 3; instructions++;
+    A = aot::Load( flags, 0xEFBE );
+
+L_2007:
+    if ( result.cycles + cycles + 5 >= limit ) {
+        next = 0x2007; goto exit;
+    }
+    // 0x2007: 50
+    cycles += 3; instructions++;
+    SP -= 2; memory.Write16( aot::Linear( SS, SP ), A );
+    if ( result.cycles + cycles >= limit ) {
+        next = 0x2008; goto exit;
+    }
+
+    // 0x2008: C5 FD
+    cycles += 2; instructions++;
+    goto L_2007;
+
+exit:
+    cpu.A.value = A; cpu.B.value = B; cpu.X = X; cpu.Y = Y;
+    cpu.SP = SP; cpu.BP = BP;
+    cpu.SS = SS; cpu.CS = CS; cpu.DS = DS;
+    cpu.SetFlags( flags );
+    cpu.IP = ip + (uint16_t)( next - start );
+    result.cycles += cycles;
+    result.instructions += instructions;
+}
+
+// Translated labels and the loops inside them
+const AotEntry btp::aotEntries[] = {
+    { "main", 0x2000, 0x2000, 0x2009, Label_main },
+    { "main+0x0007", 0x2007, 0x2000, 0x2009, Label_main },
+};
+const int btp::aotEntryCount = 2;
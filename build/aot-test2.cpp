@@ -0,0 +1,71 @@
+// Generated by btp6kaot from ../build/aot-test2.o
+
+#include "btp6000/Aot.hpp"
+
+using namespace btp;
+
+// main (0x0000)
+static void Label_main(
+    BetterThanPico &cpu,
+    Bob3k &memory,
+    RunResult &result,
+    const uint32_t &limit
+) {
+    uint16_t A = cpu.A.value, B = cpu.B.value, X = cpu.X, Y = cpu.Y;
+    uint16_t SP = cpu.SP, BP = cpu.BP;
+    uint16_t SS = cpu.SS, CS = cpu.CS, DS = cpu.DS;
+    Flags flags = cpu.GetFlags();
+    const uint16_t ip = cpu.IP;
+    const uint16_t start = aot::Linear( CS, ip );
+    uint16_t next = start; // Linear address to resume at
+    uint32_t cycles = 0, instructions = 0;
+
+    if ( result.cycles + cycles + 21 >= limit ) {
+        next = 0x0000; goto exit;
+    }
+    // 0x0000: A0 32 00
+    cycles += 3; instructions++;
+    A = aot::Load( flags, 0x0032 );
+
+    // 0x0003: 90 0C 00
+    cycles += 3; instructions++;
+    Y = aot::Load( flags, 0x000C );
+
+    // 0x0006: 81 0C
+    cycles += 4; instructions++;
+    X = aot::Load( flags, memory.Read16( aot::Linear( SS, BP + 0x0C ) ) );
+
+    // 0x0008: B1 36
+    cycles += 4; instructions++;
+    B = aot::Load( flags, memory.Read16( aot::Linear( SS, BP + 0x36 ) ) );
+
+    // 0x000A: A4
+    cycles += 5; instructions++;
+    A = aot::Load( flags, memory.Read16( aot::Linear(
+        SS, memory.Read16( aot::Linear( DS, X ) ) + Y
+    ) ) );
+
+    // 0x000B: AA
+    cycles += 1; instructions++;
+    X = A;
+
+    // 0x000C: A9
+    cycles += 1; instructions++;
+    B = A;
+    next = 0x000D; goto exit;
+
+exit:
+    cpu.A.value = A; cpu.B.value = B; cpu.X = X; cpu.Y = Y;
+    cpu.SP = SP; cpu.BP = BP;
+    cpu.SS = SS; cpu.CS = CS; cpu.DS = DS;
+    cpu.SetFlags( flags );
+    cpu.IP = ip + (uint16_t)( next - start );
+    result.cycles += cycles;
+    result.instructions += instructions;
+}
+
+// Translated labels and the loops inside them
+const AotEntry btp::aotEntries[] = {
+    { "main", 0x0000, 0x0000, 0x000C, Label_main },
+};
+const int btp::aotEntryCount = 1;
@@ -31,6 +31,7 @@
 
 #include "stdio.h"
 #include "stdint.h"
+#include "string.h"
 
 #include "../btp6kasm/lexer.hpp"
 using namespace lex;
@@ -0,0 +1,103 @@
+/*
+* Copyright © 2025 Micro-16 Team
+* 
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the “Software”), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+* 
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+* 
+* THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+#ifndef HEADLESSDISPLAY16_HPP
+#define HEADLESSDISPLAY16_HPP
+
+// Stand-in for MicroDisplay16 when building with MIDI16_HEADLESS. It only has
+// the parts of Surface that the PGU draws with, backed by plain memory, so
+// that the console can run without SDL or a display.
+
+#include <vector>
+
+#include "stdint.h"
+#include "string.h"
+
+// Micro Display 16 namespace
+namespace MiDi16 {
+
+// Simple 32bit RGBA color, laid out like SDL_Color
+struct Color {
+    uint8_t r, g, b, a;
+};
+
+// Surface class
+class Surface {
+public:
+    // Allocates the pixel data buffer, or draws into `buffer` if one is
+    // given, which must hold width * height colors and outlive the surface
+    Surface( int width, int height, Color *buffer = nullptr )
+        : w( width ), h( height ), pixels( buffer ) {
+        if ( pixels == nullptr ) {
+            storage.resize( width * height );
+            pixels = storage.data();
+        }
+    }
+
+    // Pixels may point into the surface's own storage
+    Surface( const Surface & ) = delete;
+    Surface &operator=( const Surface & ) = delete;
+
+    // Returns the width of the surface
+    int width() const {
+        return w;
+    }
+
+    // Returns the height of the surface
+    int height() const {
+        return h;
+    }
+
+    // Gets the color value at the specified pixel
+    Color Get( int x, int y ) const {
+        if ( ( 0 <= x && x < w ) && ( 0 <= y && y < h ) )
+            return pixels[y * w + x];
+        return { 0, 0, 0, 0 };
+    }
+
+    // Sets the color value at the specified pixel
+    void Set( int x, int y, Color color ) {
+        if ( ( 0 <= x && x < w ) && ( 0 <= y && y < h ) )
+            pixels[y * w + x] = color;
+    }
+
+    // Returns the pixels of row y, which must be on the surface, for drawing
+    // a whole row at once
+    Color *Row( int y ) {
+        return pixels + y * w;
+    }
+
+    // Sets all pixels to black
+    void Clear() {
+        memset( pixels, 0, w * h * sizeof( Color ) );
+    }
+
+private:
+    int w, h;
+    Color *pixels;
+    std::vector<Color> storage;
+};
+
+}
+
+#endif
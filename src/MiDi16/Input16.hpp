@@ -0,0 +1,91 @@
+/*
+* Copyright © 2025 Micro-16 Team
+* 
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the “Software”), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+* 
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+* 
+* THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+#ifndef INPUT16_HPP
+#define INPUT16_HPP
+
+// The keyboard state of one frame, without SDL, so that it can be recorded,
+// replayed and handed to a console that has no window.
+
+#include "stdint.h"
+#include "string.h"
+
+// Micro Display 16 namespace
+namespace MiDi16 {
+
+constexpr int
+    INPUT_KEY_COUNT   = 512, // Same as SDL_SCANCODE_COUNT
+    INPUT_BITMAP_SIZE = INPUT_KEY_COUNT / 8;
+
+// Keys held down and keys pressed during a frame, one bit per scancode
+struct Input {
+    uint8_t down[INPUT_BITMAP_SIZE];
+    uint8_t pressed[INPUT_BITMAP_SIZE];
+
+    // Nothing held or pressed
+    Input() {
+        Clear();
+    }
+
+    // Releases every key
+    void Clear() {
+        memset( down, 0, sizeof( down ) );
+        memset( pressed, 0, sizeof( pressed ) );
+    }
+
+    // Checks if a key is down
+    bool IsKeyDown( int scancode ) const {
+        return GetBit( down, scancode );
+    }
+
+    // Checks if a key is pressed
+    bool IsKeyPressed( int scancode ) const {
+        return GetBit( pressed, scancode );
+    }
+
+    // Marks a key as down
+    void SetKeyDown( int scancode ) {
+        SetBit( down, scancode );
+    }
+
+    // Marks a key as pressed
+    void SetKeyPressed( int scancode ) {
+        SetBit( pressed, scancode );
+    }
+
+private:
+    static bool GetBit( const uint8_t *bitmap, int scancode ) {
+        if ( scancode < 0 || scancode >= INPUT_KEY_COUNT )
+            return false;
+        return bitmap[scancode >> 3] & ( 1 << ( scancode & 7 ) );
+    }
+
+    static void SetBit( uint8_t *bitmap, int scancode ) {
+        if ( 0 <= scancode && scancode < INPUT_KEY_COUNT )
+            bitmap[scancode >> 3] |= 1 << ( scancode & 7 );
+    }
+};
+
+}
+
+#endif
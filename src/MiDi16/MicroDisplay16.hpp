@@ -34,6 +34,8 @@
 
 #include "stringextra.hpp"
 
+#include "Input16.hpp"
+
 // If x, print SDL_GetError()
 #define MiDi16_ASSERT( x ) \
     if ( ( x ) ) \
@@ -192,6 +194,20 @@ public:
         return pressedKeys;
     }
 
+    // Returns the keys down and pressed this frame
+    Input GetInput() const {
+        static_assert( INPUT_KEY_COUNT == SDL_SCANCODE_COUNT );
+        Input input;
+        const bool *keys = SDL_GetKeyboardState( NULL );
+        for ( int scancode = 0; scancode < INPUT_KEY_COUNT; scancode++ ) {
+            if ( keys[scancode] )
+                input.SetKeyDown( scancode );
+        }
+        for ( int scancode : pressedKeys )
+            input.SetKeyPressed( scancode );
+        return input;
+    }
+
     // Starts capturing text input
     void StartTextInput() {
         if ( !captureTextInput )
@@ -306,6 +322,11 @@ public:
         )
             *(Color*)( (uint32_t*)surface->pixels + y * width() + x ) = color;
     }
+    // Returns the pixels of row y, which must be on the surface, for drawing
+    // a whole row at once
+    Color *Row( int y ) {
+        return (Color*)( (uint8_t*)surface->pixels + y * surface->pitch );
+    }
     // Blits the Surface to the window
     // MiDi16 only supports one window
     void Blit( Window *window, int x, int y );
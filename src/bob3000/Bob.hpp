@@ -25,11 +25,52 @@
 
 
 #include "stdint.h"
+#include "string.h"
 
-#define BOB3K_SIZE 0x10000
+#define BOB3K_SIZE        0x10000
+#define BOB3K_PAGE_SIZE   0x100
+#define BOB3K_PAGE_COUNT  ( BOB3K_SIZE / BOB3K_PAGE_SIZE )
+#define BOB3K_WATCHER_MAX 8
+#define BOB3K_DIRTY_BLOCK_SIZE  64
+#define BOB3K_DIRTY_BLOCK_COUNT ( BOB3K_SIZE / BOB3K_DIRTY_BLOCK_SIZE )
+
+// Anything that caches the contents of memory (decoded code, sprites, ...)
+// and needs to hear when that memory changes
+class Bob3kWatcher {
+public:
+    // Virtual destructor
+    virtual ~Bob3kWatcher() = default;
+
+    // Called on the first write to a watched page, after which the page is no
+    // longer watched by this watcher
+    virtual void PageWritten( uint8_t page ) = 0;
+};
+
+// Something mapped into pages of memory, like device registers, or what
+// handles writes to read-only pages. By default reads return 0 and writes are
+// dropped.
+class Bob3kDevice {
+public:
+    // Virtual destructor
+    virtual ~Bob3kDevice() = default;
+
+    // Returns the byte at an address in a mapped page
+    virtual uint8_t Read( uint16_t address ) {
+        return 0;
+    }
+
+    // Handles a write to an address in a mapped page
+    virtual void Write( uint16_t address, uint8_t value ) {}
+};
 
 // Buffer of Bytes 3000
 // A class to manage memory
+// Each page is plain RAM unless a device is mapped over it. Reads and writes
+// of RAM pages go straight to the buffer after one lookup in a page table,
+// the others are handed to the device. Remapping a page notifies its
+// watchers, since reading it may no longer return what they cached.
+// Writes also mark their 64-byte block in a dirty map, which the console
+// clears once a frame, so that caches of memory can refresh only what changed.
 class Bob3k {
 public:
     // Empty constructor
@@ -37,25 +78,172 @@ public:
 
     // Getter
     uint8_t Read( uint16_t address ) const {
+        Bob3kDevice *device = readDevices[address >> 8];
+        if ( device != nullptr )
+            return device->Read( address );
         return buffer[address];
     }
 
     // Returns a word
+    // Words crossing a page, or the end of memory, are read a byte at a time
     uint16_t Read16( uint16_t address ) const {
+        if (
+            ( address & 0xFF ) == 0xFF ||
+            readDevices[address >> 8] != nullptr
+        )
+            return ReadBytes16( address );
         return *(uint16_t*)( buffer + address );
     }
 
     // Setter
     void Write( uint16_t address, uint8_t value ) {
+        Bob3kDevice *device = writeDevices[address >> 8];
+        if ( device != nullptr ) {
+            device->Write( address, value );
+            return;
+        }
         buffer[address] = value;
+        MarkBlock( address );
+        CheckWatch( address );
     }
 
     // Writes a word
+    // Words crossing a page, or the end of memory, are written a byte at a
+    // time
     void Write16( uint16_t address, uint16_t value ) {
+        if (
+            ( address & 0xFF ) == 0xFF ||
+            writeDevices[address >> 8] != nullptr
+        ) {
+            WriteBytes16( address, value );
+            return;
+        }
         *(uint16_t*)( buffer + address ) = value;
+        MarkBlock( address );
+        MarkBlock( address + 1 );
+        CheckWatch( address );
+    }
+
+    // Hands reads and writes of `count` pages from `first` to a device
+    void MapDevice( uint8_t first, int count, Bob3kDevice *device ) {
+        for ( int i = first; i < first + count && i < BOB3K_PAGE_COUNT; i++ )
+            MapPage( i, device, device );
+        CountDevices();
+    }
+
+    // Makes `count` pages from `first` read-only. Reads still come from the
+    // buffer, writes go to a device or are dropped without one.
+    void MapReadOnly(
+        uint8_t first,
+        int count,
+        Bob3kDevice *device = nullptr
+    ) {
+        for ( int i = first; i < first + count && i < BOB3K_PAGE_COUNT; i++ )
+            MapPage( i, nullptr, device != nullptr ? device : &dropWrites );
+        CountDevices();
+    }
+
+    // Turns `count` pages from `first` back into RAM
+    void MapRam( uint8_t first, int count ) {
+        for ( int i = first; i < first + count && i < BOB3K_PAGE_COUNT; i++ )
+            MapPage( i, nullptr, nullptr );
+        CountDevices();
+    }
+
+    // Returns true if any page is not plain RAM
+    bool HasDevices() const {
+        return mappedPages != 0;
+    }
+
+    // Returns true if reading any page may call a device, so memory may
+    // change without being written to
+    bool HasReadDevices() const {
+        return readMappedPages != 0;
+    }
+
+    // Returns true if reading a page calls a device
+    bool IsReadMapped( uint8_t page ) const {
+        return readDevices[page] != nullptr;
+    }
+
+    // Registers a watcher and returns its slot, or -1 if all slots are taken
+    int AddWatcher( Bob3kWatcher *watcher ) {
+        for ( int i = 0; i < BOB3K_WATCHER_MAX; i++ ) {
+            if ( watchers[i] == nullptr ) {
+                watchers[i] = watcher;
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    // Unregisters a watcher slot and stops watching all of its pages
+    void RemoveWatcher( int slot ) {
+        watchers[slot] = nullptr;
+        for ( int i = 0; i < BOB3K_PAGE_COUNT; i++ )
+            watchMasks[i] &= ~( 1 << slot );
+    }
+
+    // Notifies the watcher in a slot on the next write to a page
+    void WatchPage( uint8_t page, int slot ) {
+        watchMasks[page] |= 1 << slot;
+    }
+
+    // Marks bytes as written to, for writes made through data()
+    void MarkDirty( uint16_t first, uint32_t size ) {
+        for ( uint32_t i = 0; i < size; i += BOB3K_DIRTY_BLOCK_SIZE )
+            MarkBlock( first + i );
+        if ( size != 0 )
+            MarkBlock( first + size - 1 );
+    }
+
+    // Copies bytes in from outside the CPU. Like data() it bypasses devices
+    // and read-only pages, but it marks the bytes dirty and notifies the
+    // watchers of their pages.
+    void CopyIn( uint16_t first, const void *source, uint32_t size ) {
+        memcpy( buffer + first, source, size );
+        MarkDirty( first, size );
+        for ( uint32_t i = 0; i < size; i += BOB3K_PAGE_SIZE )
+            CheckWatch( first + i );
+        if ( size != 0 )
+            CheckWatch( first + size - 1 );
+    }
+
+    // Returns true if any byte in a range was written to since the last
+    // ClearDirty(), give or take the rest of its block
+    bool IsDirty( uint16_t first, uint32_t size ) const {
+        for ( uint32_t i = 0; i < size; i += BOB3K_DIRTY_BLOCK_SIZE ) {
+            if ( IsBlockDirty( first + i ) )
+                return true;
+        }
+        return size != 0 && IsBlockDirty( first + size - 1 );
+    }
+
+    // Forgets all writes so far
+    void ClearDirty() {
+        memset( dirty, 0, sizeof( dirty ) );
+    }
+
+    // Overwrites all of memory at once. Watchers hear about every watched
+    // page whose contents changed, and all of memory counts as dirty.
+    void Restore( const uint8_t *data ) {
+        for ( int i = 0; i < BOB3K_PAGE_COUNT; i++ ) {
+            if (
+                watchMasks[i] &&
+                memcmp(
+                    buffer + i * BOB3K_PAGE_SIZE,
+                    data + i * BOB3K_PAGE_SIZE,
+                    BOB3K_PAGE_SIZE
+                ) != 0
+            )
+                NotifyWatchers( i );
+        }
+        memcpy( buffer, data, BOB3K_SIZE );
+        memset( dirty, 1, sizeof( dirty ) );
     }
 
     // Raw data access
+    // Bypasses devices, read-only pages, watchers and the dirty map
     uint8_t *data() const {
         return (uint8_t*)buffer;
     }
@@ -63,6 +251,81 @@ public:
 private:
     uint8_t buffer[BOB3K_SIZE];
 
+    // One bit per watcher slot for each page
+    uint8_t watchMasks[BOB3K_PAGE_COUNT] = {};
+    Bob3kWatcher *watchers[BOB3K_WATCHER_MAX] = {};
+
+    // A byte per block rather than a bit, so that marking one is a plain
+    // store instead of a read, modify and write
+    uint8_t dirty[BOB3K_DIRTY_BLOCK_COUNT] = {};
+
+    // Marks the block of an address as dirty
+    void MarkBlock( uint16_t address ) {
+        dirty[address / BOB3K_DIRTY_BLOCK_SIZE] = 1;
+    }
+
+    // Returns true if the block of an address is dirty
+    bool IsBlockDirty( uint16_t address ) const {
+        return dirty[address / BOB3K_DIRTY_BLOCK_SIZE];
+    }
+
+    // Device handling each page, nullptr for RAM
+    Bob3kDevice *readDevices[BOB3K_PAGE_COUNT] = {};
+    Bob3kDevice *writeDevices[BOB3K_PAGE_COUNT] = {};
+    int mappedPages = 0;
+    int readMappedPages = 0;
+    Bob3kDevice dropWrites; // Handles writes to read-only pages
+
+    // Reads a word a byte at a time
+    // Kept out of line so that the RAM path of Read16() stays small
+    __attribute__(( noinline ))
+    uint16_t ReadBytes16( uint16_t address ) const {
+        return Read( address ) | ( Read( address + 1 ) << 8 );
+    }
+
+    // Writes a word a byte at a time
+    __attribute__(( noinline ))
+    void WriteBytes16( uint16_t address, uint16_t value ) {
+        Write( address, (uint8_t)value );
+        Write( address + 1, (uint8_t)( value >> 8 ) );
+    }
+
+    // Sets the devices handling a page and notifies its watchers if they
+    // changed
+    void MapPage( uint8_t page, Bob3kDevice *read, Bob3kDevice *write ) {
+        if ( readDevices[page] == read && writeDevices[page] == write )
+            return;
+        readDevices[page] = read;
+        writeDevices[page] = write;
+        NotifyWatchers( page );
+    }
+
+    // Counts the pages that are not RAM
+    void CountDevices() {
+        mappedPages = readMappedPages = 0;
+        for ( int i = 0; i < BOB3K_PAGE_COUNT; i++ ) {
+            mappedPages += readDevices[i] != nullptr ||
+                writeDevices[i] != nullptr;
+            readMappedPages += readDevices[i] != nullptr;
+        }
+    }
+
+    // Notifies watchers if an address lies in a watched page
+    void CheckWatch( uint16_t address ) {
+        if ( watchMasks[address >> 8] )
+            NotifyWatchers( address >> 8 );
+    }
+
+    // Notifies and unwatches all watchers of a page
+    void NotifyWatchers( uint8_t page ) {
+        uint8_t mask = watchMasks[page];
+        watchMasks[page] = 0;
+
+        for ( int i = 0; i < BOB3K_WATCHER_MAX; i++ ) {
+            if ( mask & ( 1 << i ) )
+                watchers[i]->PageWritten( page );
+        }
+    }
 };
 
 
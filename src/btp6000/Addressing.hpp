@@ -0,0 +1,147 @@
+/*
+* Copyright © 2025 Micro-16 Team
+* 
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the “Software”), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+* 
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+* 
+* THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+#ifndef ADDRESSING_HPP
+#define ADDRESSING_HPP
+
+// Compile-time description of the load and store instructions. Every register
+// has the same nine opcodes in the same order, only its offset and pointer
+// come from different places, so the handlers in Handlers.hpp are all one
+// template (BetterThanPico::Load/Store), generated with their opcodes from
+// this description, and so is the decoder's immediate table.
+
+// Registers that can be loaded and stored
+enum AccessRegister {
+    REG_A,
+    REG_B,
+    REG_X,
+    REG_Y,
+    REG_COUNT,
+};
+
+// Addressing modes, in opcode order from a register's base opcode
+enum AddressMode {
+    MODE_IM,  // Immediate
+    MODE_SO,  // Stack offset         [SS:BP+offset]
+    MODE_SPO, // Stack pointer offset [[SS:BP+offset]+pointer]
+    MODE_DO,  // Data offset          [DS:offset]
+    MODE_DPO, // Data pointer offset  [[DS:offset]+pointer]
+};
+
+// Where an offset or a pointer comes from
+enum OperandSource {
+    SOURCE_X,     // X-index register
+    SOURCE_Y,     // Y-pointer register
+    SOURCE_IMM8,  // Immediate byte
+    SOURCE_IMM16, // Immediate word
+};
+
+// Opcodes and operands of a register's loads and stores
+struct RegisterLayout {
+    uint8_t base;    // Opcode of the immediate load
+    uint8_t offset;  // OperandSource of the offset
+    uint8_t pointer; // OperandSource of the pointer
+};
+
+// Indexed by AccessRegister
+constexpr RegisterLayout registerLayouts[REG_COUNT] = {
+    { 0xA0, SOURCE_X,    SOURCE_Y     }, // A
+    { 0xB0, SOURCE_IMM8, SOURCE_IMM16 }, // B
+    { 0x80, SOURCE_IMM8, SOURCE_Y     }, // X
+    { 0x90, SOURCE_X,    SOURCE_IMM16 }, // Y
+};
+
+// Returns true for the modes that address SS:BP
+constexpr bool IsStackMode( int mode ) {
+    return mode == MODE_SO || mode == MODE_SPO;
+}
+
+// Returns true for the modes that go through a pointer
+constexpr bool IsPointerMode( int mode ) {
+    return mode == MODE_SPO || mode == MODE_DPO;
+}
+
+// Opcode of a load
+constexpr uint8_t LoadOpcode( int reg, int mode ) {
+    return registerLayouts[reg].base + mode;
+}
+
+// Opcode of a store (there is no immediate store)
+constexpr uint8_t StoreOpcode( int reg, int mode ) {
+    return registerLayouts[reg].base + 4 + mode;
+}
+
+static_assert(
+    LoadOpcode( REG_A, MODE_IM ) == INS_LDA_IM &&
+    StoreOpcode( REG_A, MODE_DPO ) == INS_STA_DPO &&
+    LoadOpcode( REG_B, MODE_IM ) == INS_LDB_IM &&
+    StoreOpcode( REG_B, MODE_DPO ) == INS_STB_DPO &&
+    LoadOpcode( REG_X, MODE_IM ) == INS_LDX_IM &&
+    StoreOpcode( REG_X, MODE_DPO ) == INS_STX_DPO &&
+    LoadOpcode( REG_Y, MODE_IM ) == INS_LDY_IM &&
+    StoreOpcode( REG_Y, MODE_DPO ) == INS_STY_DPO,
+    "registerLayouts does not match Instructions.hpp"
+);
+
+// Immediates that follow an opcode. When both are present the byte comes
+// first.
+struct InstructionFormat {
+    bool imm8;
+    bool imm16;
+};
+
+// Table of InstructionFormat indexed by opcode
+struct InstructionFormats {
+    InstructionFormat formats[0x100];
+
+    constexpr const InstructionFormat &operator[]( int opcode ) const {
+        return formats[opcode];
+    }
+};
+
+// Builds the format of every opcode from registerLayouts
+constexpr InstructionFormats MakeInstructionFormats() {
+    InstructionFormats table = {};
+
+    for ( int reg = 0; reg < REG_COUNT; reg++ ) {
+        const RegisterLayout &layout = registerLayouts[reg];
+
+        table.formats[LoadOpcode( reg, MODE_IM )].imm16 = true;
+        for ( int mode = MODE_SO; mode <= MODE_DPO; mode++ ) {
+            InstructionFormat format = {
+                layout.offset == SOURCE_IMM8,
+                IsPointerMode( mode ) && layout.pointer == SOURCE_IMM16,
+            };
+            table.formats[LoadOpcode( reg, mode )] = format;
+            table.formats[StoreOpcode( reg, mode )] = format;
+        }
+    }
+
+    table.formats[INS_JMP].imm8 = true;
+    table.formats[INS_INT].imm8 = true;
+    return table;
+}
+
+constexpr InstructionFormats instructionFormats = MakeInstructionFormats();
+
+#endif
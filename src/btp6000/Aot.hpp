@@ -0,0 +1,197 @@
+/*
+* Copyright © 2025 Micro-16 Team
+* 
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the “Software”), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+* 
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+* 
+* THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#ifndef AOT_HPP
+#define AOT_HPP
+
+// Support code for C++ generated by the btp6kaot translator. Each external
+// label of a cartridge becomes an AotFunction that runs the translated code
+// until it reaches an instruction it could not translate, leaves the code
+// chunk, changes CS or would run past the end of the slice. Aot stitches the
+// functions together with the interpreter.
+
+#include "stdint.h"
+
+#include "Btp.hpp"
+
+// The Better Than Pico 6000 namespace
+namespace btp {
+
+    // Translated code starting at a label. Adds to result and returns before
+    // a run of instructions up to the next jump would take result.cycles to
+    // `limit`, and after a write that lowered `limit` to result.cycles.
+    typedef void (*AotFunction)(
+        BetterThanPico &cpu,
+        Bob3k &memory,
+        RunResult &result,
+        const uint32_t &limit
+    );
+
+    // A translated label
+    struct AotEntry {
+        const char *name;
+        uint16_t address; // Linear address of the label
+        uint16_t first;   // Linear addresses of the first and last byte of
+        uint16_t last;    // the code the function was translated from
+        AotFunction function;
+    };
+
+    // Defined by the generated translation unit
+    extern const AotEntry aotEntries[];
+    extern const int aotEntryCount;
+
+    // Helpers used by the generated code
+    namespace aot {
+
+        // Calculates an address from a segment and an offset
+        inline uint16_t Linear( uint16_t segment, uint16_t offset ) {
+            return ( segment << 4 ) + offset;
+        }
+
+        // Sets the flags like every load does and returns the value
+        inline uint16_t Load( Flags &flags, uint16_t value ) {
+            flags.Z = ( value == 0 );
+            flags.N = ( value >> 15 );
+            return value;
+        }
+
+    }
+
+    // Runs translated code whenever CS:IP is at one of the entries and
+    // interprets everything else, on a CPU whose memory must already be set.
+    // Writing to translated code turns off the functions translated from it
+    // for good, so self-modifying code runs on the interpreter.
+    class Aot : public Bob3kWatcher {
+    public:
+        // Attaches the translated code to a CPU. Without a free watcher slot
+        // on its memory nothing is translated and everything is interpreted.
+        Aot(
+            BetterThanPico *cpu,
+            const AotEntry *entries,
+            int entryCount
+        ) : cpu( cpu ), memory( cpu->memory ),
+            entries( entries ), entryCount( entryCount ) {
+            watcherSlot = memory->AddWatcher( this );
+            functions = new AotFunction[BOB3K_SIZE]();
+
+            // Translated code could never be turned off if written to
+            if ( watcherSlot == -1 )
+                return;
+
+            // Earlier entries win, the translator lists labels first
+            for ( int i = 0; i < entryCount; i++ ) {
+                const AotEntry &entry = entries[i];
+                if ( functions[entry.address] == nullptr )
+                    functions[entry.address] = entry.function;
+                for (
+                    int page = entry.first >> 8;
+                    page <= entry.last >> 8;
+                    page++
+                )
+                    memory->WatchPage( page, watcherSlot );
+            }
+        }
+
+        // Stops watching the code
+        ~Aot() {
+            if ( watcherSlot != -1 )
+                memory->RemoveWatcher( watcherSlot );
+            delete[] functions;
+        }
+
+        // Owns the function table
+        Aot( const Aot & ) = delete;
+        Aot &operator=( const Aot & ) = delete;
+
+        // Same as BetterThanPico::RunCycles(). Breakpoints, tracers and
+        // profilers are only honored by the interpreter, so this falls back
+        // to it while any are attached.
+        RunResult RunCycles( uint32_t budget ) {
+            if ( cpu->HasBreakpoints() || cpu->observed )
+                return cpu->RunCycles( budget );
+
+            RunResult result = { 0, 0, STOP_BUDGET };
+            cpu->cycleLimit = cpu->waiting ? 0 : budget;
+            cpu->idleStart = -1;
+
+            while ( true ) {
+                if ( cpu->halted ) {
+                    result.reason = STOP_HALT;
+                    break;
+                }
+                if ( result.cycles >= cpu->cycleLimit ) {
+                    result.reason = cpu->SliceEnd( result.cycles, budget );
+                    break;
+                }
+
+                uint16_t address = cpu->CalculateAddress( cpu->CS, cpu->IP );
+                AotFunction function = functions[address];
+                uint32_t instructions = result.instructions;
+                if ( function != nullptr )
+                    function( *cpu, *memory, result, cpu->cycleLimit );
+
+                // Not translated, or too close to the end of the slice for
+                // the translated code to run up to its next jump
+                if ( result.instructions == instructions ) {
+                    result.cycles += cpu->Execute();
+                    result.instructions++;
+                }
+            }
+
+            return result;
+        }
+
+        // Same as BetterThanPico::RunFrame(), running the slices between
+        // events with RunCycles(), so interrupts and the timer work
+        RunResult RunFrame() {
+            if ( cpu->HasBreakpoints() || cpu->observed )
+                return cpu->RunFrame();
+
+            return cpu->RunFrameWith( [this]( uint32_t budget ) {
+                return RunCycles( budget );
+            } );
+        }
+
+        // Turns off the functions translated from a page when it is written
+        // to, and ends the slice so that a running function returns
+        void PageWritten( uint8_t page ) override {
+            for ( int i = 0; i < entryCount; i++ ) {
+                const AotEntry &entry = entries[i];
+                if ( page >= entry.first >> 8 && page <= entry.last >> 8 )
+                    functions[entry.address] = nullptr;
+            }
+            cpu->cycleLimit = 0;
+        }
+
+    private:
+        BetterThanPico *cpu;
+        Bob3k *memory;
+        int watcherSlot;
+
+        const AotEntry *entries;
+        int entryCount;
+        AotFunction *functions; // Translated code by linear address
+    };
+
+}
+
+#endif
@@ -20,119 +20,299 @@
 * SOFTWARE.
 */
 
+#include <cstring>
+
 #include "Btp.hpp"
 
 namespace btp {
 
-// Executes one instruction
-void BetterThanPico::Execute() {
-    uint8_t instruction = Fetch();
-    #ifdef BTP_DEBUG
-    printf(
-        "INS: %02X IP: %02X A: %02X B: %02X X: %02X Y: %02X\n",
-        instruction, IP, A.value, B.value, X, Y
-    );
-
-    #endif
-    switch ( instruction ) {
-        // LDA
-        case INS_LDA_IM:  A.value = LoadImmediate();                    break;
-        case INS_LDA_SO:  A.value = LoadOffset( SS, BP + X );           break;
-        case INS_LDA_SPO: A.value = LoadPointerOffset( SS, BP + X, Y ); break;
-        case INS_LDA_DO:  A.value = LoadOffset( DS, X );                break;
-        case INS_LDA_DPO: A.value = LoadPointerOffset( DS, X, Y );      break;
-
-        // STA
-        case INS_STA_SO:  StoreOffset( SS, BP + X, A.value );           break;
-        case INS_STA_SPO: StorePointerOffset( SS, BP + X, Y, A.value ); break;
-        case INS_STA_DO:  StoreOffset( DS, X, A.value );                break;
-        case INS_STA_DPO: StorePointerOffset( DS, X, Y, A.value );      break;
-
-        // TA-X
-        case INS_TAB:     B.value = A.value;                            break;
-        case INS_TAX:     X = A.value;                                  break;
-        case INS_TAY:     Y = A.value;                                  break;
-        case INS_TASS:    SS = A.value;                                 break;
-        case INS_TACS:    CS = A.value;                                 break;
-        case INS_TADS:    DS = A.value;                                 break;
-
-        // LDB
-        case INS_LDB_IM:  B.value = LoadImmediate();                    break;
-        case INS_LDB_SO:  B.value = LoadOffsetIm( SS, BP );             break;
-        case INS_LDB_SPO: B.value = LoadPointerImOffsetIm( SS, BP, 0 ); break;
-        case INS_LDB_DO:  B.value = LoadOffsetIm( DS, 0 );              break;
-        case INS_LDB_DPO: B.value = LoadPointerImOffsetIm( DS, 0, 0 );  break;
-
-        // STB
-        case INS_STB_SO:  StoreOffsetIm( SS, BP, B.value );             break;
-        case INS_STB_SPO: StorePointerImOffsetIm( SS, BP, 0, B.value ); break;
-        case INS_STB_DO:  StoreOffsetIm( DS, 0, B.value );              break;
-        case INS_STB_DPO: StorePointerImOffsetIm( DS, 0, 0, B.value );  break;
-
-        // TB-X
-        case INS_TBA:     A.value = B.value;                            break;
-        case INS_TBX:     X = B.value;                                  break;
-        case INS_TBY:     Y = B.value;                                  break;
-        case INS_TBSS:    SS = B.value;                                 break;
-        case INS_TBCS:    CS = B.value;                                 break;
-        case INS_TBDS:    DS = B.value;                                 break;
-
-        // LDX
-        case INS_LDX_IM:  X = LoadImmediate();                          break;
-        case INS_LDX_SO:  X = LoadOffsetIm( SS, BP );                   break;
-        case INS_LDX_SPO: X = LoadPointerOffsetIm( SS, BP, Y );         break;
-        case INS_LDX_DO:  X = LoadOffsetIm( DS, 0 );                    break;
-        case INS_LDX_DPO: X = LoadPointerOffsetIm( DS, 0, Y );          break;
-
-        // STX
-        case INS_STX_SO:  StoreOffsetIm( SS, BP, X );                   break;
-        case INS_STX_SPO: StorePointerOffsetIm( SS, BP, Y, X );         break;
-        case INS_STX_DO:  StoreOffsetIm( DS, 0, X );                    break;
-        case INS_STX_DPO: StorePointerOffsetIm( DS, 0, Y, X );          break;
-
-        // TX-X
-        case INS_TXA:     A.value = X;                                  break;
-        case INS_TXB:     B.value = X;                                  break;
-        case INS_TXY:     Y = X;                                        break;
-        case INS_TXSS:    SS = X;                                       break;
-        case INS_TXCS:    CS = X;                                       break;
-        case INS_TXDS:    DS = X;                                       break;
-
-        // LDY
-        case INS_LDY_IM:  Y = LoadImmediate();                          break;
-        case INS_LDY_SO:  Y = LoadOffset( SS, BP + X );                 break;
-        case INS_LDY_SPO: Y = LoadPointerImOffset( SS, BP + X, 0 );     break;
-        case INS_LDY_DO:  Y = LoadOffset( DS, X );                      break;
-        case INS_LDY_DPO: Y = LoadPointerImOffset( DS, X, 0 );          break;
-
-        // STY
-        case INS_STY_SO:  StoreOffset( SS, BP + X, Y );                 break;
-        case INS_STY_SPO: StorePointerImOffset( SS, BP + X, 0, Y );     break;
-        case INS_STY_DO:  StoreOffset( DS, X, Y );                      break;
-        case INS_STY_DPO: StorePointerImOffset( DS, X, 0, Y );          break;
-
-        // TY-X
-        case INS_TYA:     A.value = Y;                                  break;
-        case INS_TYB:     B.value = Y;                                  break;
-        case INS_TYX:     X = Y;                                        break;
-        case INS_TYSS:    SS = Y;                                       break;
-        case INS_TYCS:    CS = Y;                                       break;
-        case INS_TYDS:    DS = Y;                                       break;
-
-        case INS_PUSHA:   Push16( A.value );                            break;
-        case INS_POPA:    A.value = Pop16();                            break;
-        case INS_PUSHB:   Push16( B.value );                            break;
-        case INS_POPB:    B.value = Pop16();                            break;
-        case INS_PUSHX:   Push16( X );                                  break;
-        case INS_POPX:    X = Pop16();                                  break;
-        case INS_PUSHY:   Push16( Y );                                  break;
-        case INS_POPY:    Y = Pop16();                                  break;
-        case INS_ENTER:   Push16( BP ); BP = SP;                        break;
-        case INS_LEAVE:   SP = BP; BP = Pop16();                        break;
-
-        // JMP
-        case INS_JMP:     IP += (int8_t)Fetch();                        break;
+// Executes one instruction and returns the cycles it took
+int BetterThanPico::Execute() {
+    // Copied, since a store may invalidate the cached entry
+    const DecodedInstruction ins =
+        decodeCache.Lookup( CalculateAddress( CS, IP ) );
+    if ( observed )
+        ObserveInstruction( ins );
+    IP += ins.length;
+
+    switch ( ins.opcode ) {
+        #define HANDLER( name, opcode, ... ) case opcode: __VA_ARGS__; break;
+        #include "Handlers.hpp"
+        #undef HANDLER
+
+        // Undefined
+        default: IP--; halted = true; break;
+    }
+
+    return ins.cycles;
+}
+
+#ifndef BTP_THREADED
+// Executes instructions until the cycle budget runs out, the CPU halts or
+// CS:IP reaches a breakpoint
+RunResult BetterThanPico::RunCycles( uint32_t budget ) {
+    RunResult result = { 0, 0, STOP_BUDGET };
+    bool resuming = true; // Ignore a breakpoint at the starting CS:IP
+    cycleLimit = waiting ? 0 : budget;
+    idling = false;
+    idleStart = -1; // A loop must repeat within one uninterrupted slice
+
+    while ( true ) {
+        if ( halted ) {
+            result.reason = STOP_HALT;
+            break;
+        }
+        if ( result.cycles >= cycleLimit ) {
+            if ( SkipIdleLoop( result, budget ) )
+                continue;
+            result.reason = SliceEnd( result.cycles, budget );
+            break;
+        }
+        if (
+            breakpointCount != 0 && !resuming &&
+            breakpoints[CalculateAddress( CS, IP )]
+        ) {
+            result.reason = STOP_BREAKPOINT;
+            break;
+        }
+        resuming = false;
+
+        result.cycles += Execute();
+        result.instructions++;
+    }
+
+    return result;
+}
+#else
+// Opcodes of the handlers, in Handlers.hpp order
+static constexpr uint8_t handlerOpcodes[] = {
+    #define HANDLER( name, opcode, ... ) opcode,
+    #include "Handlers.hpp"
+    #undef HANDLER
+};
+
+constexpr int HANDLER_COUNT = sizeof( handlerOpcodes );
+static_assert( HANDLER_COUNT < 0x100, "handler indices are bytes" );
+
+// Index into handlerOpcodes of every opcode's handler, HANDLER_COUNT for
+// undefined opcodes
+struct HandlerIndices {
+    uint8_t indices[0x100];
+};
+
+// Builds the index of every opcode's handler, failing to compile if two
+// handlers share an opcode
+static constexpr HandlerIndices MakeHandlerIndices() {
+    HandlerIndices table = {};
+
+    for ( int opcode = 0; opcode < 0x100; opcode++ )
+        table.indices[opcode] = HANDLER_COUNT;
+    for ( int handler = 0; handler < HANDLER_COUNT; handler++ ) {
+        uint8_t &index = table.indices[handlerOpcodes[handler]];
+        if ( index != HANDLER_COUNT )
+            throw "two handlers share an opcode";
+        index = handler;
+    }
+    return table;
+}
+
+static constexpr HandlerIndices handlerIndices = MakeHandlerIndices();
+
+// Threaded handler labels indexed by opcode
+struct HandlerTable {
+    void *labels[0x100];
+};
+
+// Builds the threaded core's table from its labels, given in Handlers.hpp
+// order and followed by the undefined handler
+static HandlerTable MakeHandlerTable( void *const *labels ) {
+    HandlerTable table;
+
+    for ( int opcode = 0; opcode < 0x100; opcode++ )
+        table.labels[opcode] = labels[handlerIndices.indices[opcode]];
+    return table;
+}
+
+// Executes instructions until the cycle budget runs out, the CPU halts or
+// CS:IP reaches a breakpoint
+// Threaded version: instead of looping back to a single switch, every handler
+// looks up the next instruction and jumps straight to its handler, which
+// gives the host branch predictor one indirect jump per handler to learn.
+RunResult BetterThanPico::RunCycles( uint32_t budget ) {
+    // Handler labels in Handlers.hpp order, then the undefined handler
+    static void *const labels[HANDLER_COUNT + 1] = {
+        #define HANDLER( name, ... ) &&name,
+        #include "Handlers.hpp"
+        #undef HANDLER
+        &&UD,
+    };
+    // Handler labels indexed by opcode
+    static const HandlerTable handlers = MakeHandlerTable( labels );
+
+    RunResult result = { 0, 0, STOP_BUDGET };
+    DecodedInstruction ins;
+
+    // Looks up the instruction at CS:IP and jumps to its handler
+    #define JUMP_TO_NEXT()                                          \
+        ins = decodeCache.Lookup( CalculateAddress( CS, IP ) );     \
+        if ( observed )                                             \
+            ObserveInstruction( ins );                              \
+        IP += ins.length;                                           \
+        result.cycles += ins.cycles;                                \
+        result.instructions++;                                      \
+        goto *handlers.labels[ins.opcode]
+
+    // Runs the next handler, leaving the budget and breakpoints to the
+    // shared code below so that every handler stays small
+    #define DISPATCH()                                              \
+        if ( result.cycles >= cycleLimit )                          \
+            goto SLICE_END;                                         \
+        if ( breakpointCount != 0 )                                 \
+            goto BREAKPOINT;                                        \
+        JUMP_TO_NEXT()
+
+    if ( halted ) {
+        result.reason = STOP_HALT;
+        return result;
+    }
+    cycleLimit = waiting ? 0 : budget;
+    idling = false;
+    idleStart = -1; // A loop must repeat within one uninterrupted slice
+    if ( cycleLimit == 0 ) {
+        result.reason = SliceEnd( 0, budget );
+        return result;
     }
+
+    // A breakpoint at the starting CS:IP is ignored
+    JUMP_TO_NEXT();
+
+    #define HANDLER( name, opcode, ... ) name: __VA_ARGS__; DISPATCH();
+    #include "Handlers.hpp"
+    #undef HANDLER
+
+    // Undefined
+    UD:
+        IP--;
+        halted = true;
+        result.reason = STOP_HALT;
+        return result;
+
+    // Stops at the end of the budget, unless an idle loop was skipped up to
+    // short of it
+    SLICE_END:
+        if ( !SkipIdleLoop( result, budget ) || result.cycles >= cycleLimit ) {
+            result.reason = SliceEnd( result.cycles, budget );
+            return result;
+        }
+
+    // Stops at a breakpoint
+    BREAKPOINT:
+        if ( breakpoints[CalculateAddress( CS, IP )] ) {
+            result.reason = STOP_BREAKPOINT;
+            return result;
+        }
+        JUMP_TO_NEXT();
+
+    #undef DISPATCH
+    #undef JUMP_TO_NEXT
+}
+#endif
+
+// Hands the instruction about to run to the tracer and profiler
+void BetterThanPico::ObserveInstruction( DecodedInstruction ins ) {
+    if ( tracer != nullptr )
+        tracer->Record( {
+            CS, IP, SP, A.value, B.value, X, Y,
+            ins.opcode, GetFlags().value,
+        } );
+    if ( profiler != nullptr )
+        profiler->Record( CalculateAddress( CS, IP ), ins );
+}
+
+// Ends the slice if the backward JMP just run closed an idle loop
+void BetterThanPico::CheckIdleLoop( const DecodedInstruction &jump ) {
+    // Device reads may change from one iteration to the next
+    if (
+        !idleSkipping || observed || breakpointCount != 0 ||
+        memory->HasReadDevices()
+    )
+        return;
+
+    uint16_t start = CalculateAddress( CS, IP );
+    uint16_t address = start - (int8_t)jump.imm8 - jump.length;
+    if ( busyLoops[address] )
+        return;
+
+    if ( start != idleStart || address != idleJump ) {
+        // A new loop: work out whether it can be idle, and forget about it if
+        // its code changes
+        if ( watcherSlot != -1 )
+            memory->WatchPage( address >> 8, watcherSlot );
+        if ( !AnalyzeLoop( start, address ) ) {
+            busyLoops.set( address );
+            return;
+        }
+        idleStart = start;
+        idleJump = address;
+        idleState = GetState();
+        idleChanges = 0;
+        return;
+    }
+
+    // Memory cannot change inside the loop, so once an iteration comes back
+    // to the same state, so will every other one
+    CpuState state = GetState();
+    if ( memcmp( &state, &idleState, sizeof( CpuState ) ) == 0 ) {
+        idling = true;
+        cycleLimit = 0;
+        idleChanges = 0;
+    }
+    else if ( ++idleChanges == IDLE_SETTLE_LIMIT )
+        busyLoops.set( address );
+    else
+        idleState = state;
+}
+
+// Returns true if a loop cannot write memory or change CS
+bool BetterThanPico::AnalyzeLoop( uint16_t start, uint16_t jump ) {
+    // Only loops within a page, whose code one watch covers
+    if ( start > jump || start >> 8 != ( jump + 1 ) >> 8 )
+        return false;
+
+    uint32_t cycles = 0, instructions = 0;
+    uint32_t address = start;
+    while ( address < jump ) {
+        DecodedInstruction ins = decodeCache.Lookup( address );
+        uint8_t family = ins.opcode >> 4;
+        uint8_t low = ins.opcode & 0xF;
+
+        // Loads, transfers other than to CS, pops and LEAVE
+        bool registerFamily = family >= 0x8 && family <= 0xB;
+        bool load = registerFamily && low <= 0x4;
+        bool transfer = registerFamily && low >= 0x9 && low <= 0xE &&
+            low != 0xD;
+        bool pop = ins.opcode >= INS_POPA && ins.opcode <= INS_POPY &&
+            ( ins.opcode & 1 );
+        if ( !load && !transfer && !pop && ins.opcode != INS_LEAVE )
+            return false;
+
+        cycles += ins.cycles;
+        instructions++;
+        address += ins.length;
+    }
+    if ( address != jump )
+        return false;
+
+    idleCycles = cycles + decodeCache.Lookup( jump ).cycles;
+    idleInstructions = instructions + 1;
+    return true;
+}
+
+// Runs one frame worth of cycles, paying back the previous frame's overshoot
+RunResult BetterThanPico::RunFrame() {
+    return RunFrameWith( [this]( uint32_t budget ) {
+        return RunCycles( budget );
+    } );
 }
 
 #ifdef BTP_DEBUG
@@ -144,6 +324,6 @@ void BetterThanPico::DumpMemory( const char *outputFile ) {
 
     file.close();
 }
+#endif
 
-}
-#endif
\ No newline at end of file
+}
\ No newline at end of file
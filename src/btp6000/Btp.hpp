@@ -23,19 +23,99 @@
 #ifndef BTP_HPP
 #define BTP_HPP
 
+// Define BTP_RELEASE (-DBTP_RELEASE) to build without the debug helpers
+#ifndef BTP_RELEASE
 #define BTP_DEBUG
+#endif
 
+// Define BTP_THREADED (-DBTP_THREADED) to run RunCycles() on the threaded
+// core, which dispatches with GCC/Clang labels-as-values instead of a switch.
+// It has not measured faster than the switch core so far (see bench/), so it
+// is off by default.
+// #define BTP_THREADED
+
+#if defined( BTP_THREADED ) && !defined( __GNUC__ )
+#error "BTP_THREADED needs a compiler with labels-as-values (GCC or Clang)"
+#endif
+
+#include <algorithm>
+#include <bitset>
 #include <fstream>
 
 #include "stdio.h"
 #include "stdint.h"
 
 #include "../bob3000/Bob.hpp"
+#include "DecodeCache.hpp"
+#include "Profiler.hpp"
+#include "Trace.hpp"
 
 // The Better Than Pico 6000 namespace
 namespace btp {
     #include "Instructions.hpp"
+    #include "Addressing.hpp"
+
+    constexpr uint32_t
+        CLOCK_SPEED      = 1000000, // Cycles per second
+        FRAME_RATE       = 60,      // Frames per second
+        CYCLES_PER_FRAME = CLOCK_SPEED / FRAME_RATE;
+
+    // Iterations in a row an idle loop candidate may change the state in
+    // before it is taken for a busy loop
+    constexpr uint32_t IDLE_SETTLE_LIMIT = 16;
+
+    // Interrupts
+    // The interrupt table holds a CS and an IP word for every vector, a
+    // vector whose entry is 0:0 is not installed. The timer raises
+    // IRQ_TIMER every TIMER_PERIOD cycles while TIMER_PERIOD is not 0.
+    constexpr uint16_t
+        INTERRUPT_TABLE = 0x3F00,
+        INTERRUPT_COUNT = 16,
+        TIMER_PERIOD    = INTERRUPT_TABLE + INTERRUPT_COUNT * 4;
+    constexpr uint8_t INTERRUPT_PAGE = INTERRUPT_TABLE >> 8;
+
+    // Address of a vector's entry in the interrupt table
+    constexpr uint16_t InterruptEntry( uint8_t vector ) {
+        return INTERRUPT_TABLE + ( vector % INTERRUPT_COUNT ) * 4;
+    }
+
+    // Interrupt vectors raised by the hardware
+    enum Interrupt {
+        IRQ_VBLANK, // Start of every frame
+        IRQ_TIMER,  // The timer ran out
+    };
+
+    // Reasons for a batch of instructions to stop running
+    enum StopReason {
+        STOP_BUDGET,     // The cycle budget ran out
+        STOP_HALT,       // The CPU halted
+        STOP_BREAKPOINT, // CS:IP reached a breakpoint
+        STOP_WAIT,       // The CPU waits for an interrupt
+        STOP_EVENT,      // An interrupt or the timer needs the frame loop
+    };
+
+    // Result of running a batch of instructions
+    struct RunResult {
+        uint32_t cycles;       // Cycles consumed
+        uint32_t instructions; // Instructions executed
+        int reason;            // StopReason
+    };
 
+    // Everything needed to resume a CPU, laid out for save states
+    struct CpuState {
+        uint16_t A, B, X, Y;
+        uint16_t IP, SP, BP;
+        uint16_t SS, CS, DS;
+        uint8_t flags;
+        uint8_t halted;
+        uint16_t pendingInterrupts; // Bit per vector
+        uint32_t cycleDebt;
+        uint32_t timerCycles;       // Cycles since the timer last ran out
+        uint8_t waiting;            // Stopped by WAI
+        uint8_t reserved;           // Always 0
+        uint16_t timerPeriod;       // TIMER_PERIOD the timer is counting to
+    };
+    static_assert( sizeof( CpuState ) == 36, "CpuState is not packed" );
 
     // General purpose register
     union Register {
@@ -59,7 +139,15 @@ namespace btp {
     };
 
     // CPU class
-    class BetterThanPico {
+    // Watches the interrupt page so that a program writing its interrupt
+    // table or timer period is heard before the end of the frame
+    class BetterThanPico : public Bob3kWatcher {
+        // The recompiler, translated code runner and lockstep interpreter
+        // work on the registers and internals directly
+        friend class Aot;
+        friend class Jit;
+        friend class Lockstep;
+
     public:
         // General purpose registers
         //     Accumulator
@@ -83,15 +171,25 @@ namespace btp {
         //     Data segment
         uint16_t SS, CS, DS;
 
-        // Flags
-        Flags flags;
-
         // Default constructor
         BetterThanPico() {}
 
+        // Stops watching the memory
+        ~BetterThanPico() {
+            if ( memory != nullptr && watcherSlot != -1 )
+                memory->RemoveWatcher( watcherSlot );
+        }
+
         // Sets up the memory
         void SetMemory( Bob3k *memory ) {
+            if ( this->memory != nullptr && watcherSlot != -1 )
+                this->memory->RemoveWatcher( watcherSlot );
+
             this->memory = memory;
+            watcherSlot = memory->AddWatcher( this );
+            decodeCache.SetMemory( memory );
+            idleStart = -1;
+            busyLoops.reset();
         }
 
         void Reset() {
@@ -99,10 +197,154 @@ namespace btp {
             A.value = B.value = X = Y = 
             IP = SP = BP = SS = CS = DS = 
             flags.value = 0;
+
+            halted = false;
+            cycleDebt = 0;
+            pendingInterrupts = 0;
+            waiting = false;
+            timerPeriod = 0;
+            timerCycles = 0;
+            idleStart = -1;
+            busyLoops.reset();
+            decodeCache.Flush();
+        }
+
+        // Executes one instruction and returns the cycles it took
+        // Undefined opcodes halt the CPU with IP pointing at them
+        int Execute();
+
+        // Executes instructions until the cycle budget runs out, the CPU
+        // halts or CS:IP reaches a breakpoint. The last instruction may
+        // overshoot the budget. A breakpoint at the starting CS:IP is ignored
+        // so that a stopped CPU can be resumed.
+        // Interrupts are not taken and the timer does not run: this stops
+        // early on WAI (STOP_WAIT), and when RTI unmasks a pending interrupt
+        // or the interrupt page is written to (STOP_EVENT).
+        // Idle loops, closed by a backward JMP, that cannot write memory or
+        // change CS and came back to the same state are fast-forwarded by
+        // whole iterations to the end of the slice instead of being run.
+        RunResult RunCycles( uint32_t budget );
+
+        // Runs one frame worth of cycles, paying back the previous frame's
+        // overshoot. Raises IRQ_VBLANK first, then runs the timer and takes
+        // interrupts between slices of RunCycles(), and skips straight to
+        // the next event while waiting for an interrupt.
+        RunResult RunFrame();
+
+        // Marks an interrupt as pending if its vector is installed. The
+        // lowest pending vector is taken at the next event once IF is clear.
+        void RaiseInterrupt( uint8_t vector ) {
+            if ( IsVectorInstalled( vector ) )
+                pendingInterrupts |= 1 << ( vector % INTERRUPT_COUNT );
+        }
+
+        // Returns true if the CPU is stopped by WAI
+        bool IsWaiting() const {
+            return waiting;
+        }
+
+        // Ends the running slice early when the interrupt page is written to,
+        // and forgets what it knows about loops in code that was
+        void PageWritten( uint8_t page ) override {
+            if ( page == INTERRUPT_PAGE )
+                cycleLimit = 0;
+            if ( idleStart >> 8 == page )
+                idleStart = -1;
+            for ( int i = 0; i < BOB3K_PAGE_SIZE; i++ )
+                busyLoops.reset( page << 8 | i );
+        }
+
+        // Turns fast-forwarding idle loops on or off, it is on by default
+        // Loops are never skipped while observed or with breakpoints set
+        void SetIdleSkipping( bool enabled ) {
+            idleSkipping = enabled;
         }
 
-        // Executes one instruction
-        void Execute();
+        // Returns the cycles fast-forwarded through idle loops since the CPU
+        // was created
+        uint64_t SkippedCycles() const {
+            return skippedCycles;
+        }
+
+        // Returns the flags
+        Flags GetFlags() const {
+            return flags;
+        }
+
+        // Overwrites the flags
+        void SetFlags( Flags flags ) {
+            this->flags = flags;
+        }
+
+        // Starts recording every interpreted instruction into a tracer, or
+        // stops when given nullptr. The recompiler falls back to the
+        // interpreter while tracing, translated (AOT) code is not traced.
+        void SetTracer( Tracer *tracer ) {
+            this->tracer = tracer;
+            observed = tracer != nullptr || profiler != nullptr;
+        }
+
+        // Starts counting every interpreted instruction in a profiler, or
+        // stops when given nullptr. Like tracing, this keeps the recompiler
+        // out of the way and misses translated (AOT) code.
+        void SetProfiler( Profiler *profiler ) {
+            this->profiler = profiler;
+            observed = tracer != nullptr || profiler != nullptr;
+        }
+
+        // Returns the registers and internal state
+        CpuState GetState() {
+            return {
+                A.value, B.value, X, Y, IP, SP, BP, SS, CS, DS,
+                GetFlags().value, halted, pendingInterrupts, cycleDebt,
+                timerCycles, waiting, 0, timerPeriod,
+            };
+        }
+
+        // Restores the registers and internal state, keeping breakpoints
+        void SetState( const CpuState &state ) {
+            A.value = state.A; B.value = state.B; X = state.X; Y = state.Y;
+            IP = state.IP; SP = state.SP; BP = state.BP;
+            SS = state.SS; CS = state.CS; DS = state.DS;
+            SetFlags( { state.flags } );
+            halted = state.halted;
+            pendingInterrupts = state.pendingInterrupts;
+            cycleDebt = state.cycleDebt;
+            timerCycles = state.timerCycles;
+            waiting = state.waiting;
+            timerPeriod = state.timerPeriod;
+            idleStart = -1;
+        }
+
+        // Returns true if the CPU stopped on an undefined opcode
+        bool IsHalted() const {
+            return halted;
+        }
+
+        // Stops execution before the instruction at a linear address
+        void AddBreakpoint( uint16_t address ) {
+            if ( !breakpoints[address] )
+                breakpointCount++;
+            breakpoints.set( address );
+        }
+
+        // Removes a breakpoint at a linear address
+        void RemoveBreakpoint( uint16_t address ) {
+            if ( breakpoints[address] )
+                breakpointCount--;
+            breakpoints.reset( address );
+        }
+
+        // Removes all breakpoints
+        void ClearBreakpoints() {
+            breakpoints.reset();
+            breakpointCount = 0;
+        }
+
+        // Returns true if any breakpoint is set
+        bool HasBreakpoints() const {
+            return breakpointCount != 0;
+        }
 
         #ifdef BTP_DEBUG
         // Dumps all the memory to a file
@@ -111,7 +353,38 @@ namespace btp {
         #endif
 
     private:
-        Bob3k *memory;
+        Bob3k *memory = nullptr;
+        int watcherSlot = -1;
+        DecodeCache decodeCache;
+        Tracer *tracer = nullptr;
+        Profiler *profiler = nullptr;
+        bool observed = false; // A tracer or profiler is attached
+
+        Flags flags = {};
+
+        bool halted = false;
+        uint32_t cycleDebt = 0; // Cycles the last frame overshot by
+        uint32_t cycleLimit = 0; // Budget of the running slice, 0 to stop
+
+        // Interrupts and the timer
+        uint16_t pendingInterrupts = 0; // Bit per vector
+        bool waiting = false;           // Stopped by WAI
+        uint16_t timerPeriod = 0;       // Last TIMER_PERIOD seen
+        uint32_t timerCycles = 0;       // Cycles since the timer ran out
+        std::bitset<BOB3K_SIZE> breakpoints;
+        uint32_t breakpointCount = 0;
+
+        // Idle loop skipping
+        bool idleSkipping = true;
+        bool idling = false;            // Jump() closed an idle loop
+        int32_t idleStart = -1;         // Linear address of the last loop
+        uint16_t idleJump = 0;          // and of the JMP closing it
+        uint32_t idleCycles = 0;        // Cycles per iteration
+        uint32_t idleInstructions = 0;  // Instructions per iteration
+        CpuState idleState = {};        // State after the last iteration
+        uint32_t idleChanges = 0;       // Iterations in a row that changed it
+        uint64_t skippedCycles = 0;
+        std::bitset<BOB3K_SIZE> busyLoops; // JMPs closing loops that write
 
         // Calculates an address from a segment and an offset
         // Similar to x86 memory segmentation:
@@ -147,19 +420,11 @@ namespace btp {
             memory->Write16( CalculateAddress( segment, offset ), value );
         }
 
-        // Fetches a byte from CS:IP and increments IP
-        uint8_t Fetch() {
-            uint8_t value = Read( CS, IP );
-            IP++;
-            return value;
-        }
-
-        // Fetches a word from CS:IP and increments IP
-        uint16_t Fetch16() {
-            uint16_t value = Read16( CS, IP );
-            IP += 2;
-            return value;
-        }
+        // Hands the instruction about to run to the tracer and profiler
+        // Kept out of line so that the unobserved path stays small, and takes
+        // the instruction by value so that the threaded core's copy can stay
+        // in registers
+        void ObserveInstruction( DecodedInstruction ins );
 
         // Most AB register operations will run this generic function
         void GenericFlagSet( uint16_t value ) {
@@ -174,126 +439,63 @@ namespace btp {
             flags.N = a >= b;
         }
 
-        // Load Immediate value
-        uint16_t LoadImmediate() {
-            uint16_t value = Fetch16();
-            GenericFlagSet( value );
-            return value;
+        // Returns a load/store register by AccessRegister
+        template <int reg>
+        uint16_t &AccessedRegister() {
+            if constexpr ( reg == REG_A ) return A.value;
+            if constexpr ( reg == REG_B ) return B.value;
+            if constexpr ( reg == REG_X ) return X;
+            if constexpr ( reg == REG_Y ) return Y;
         }
 
-        // Load offset value
-        uint16_t LoadOffset( uint16_t segment, uint16_t offset ) {
-            uint16_t value = Read16( segment, offset );
-            GenericFlagSet( value );
-            return value;
+        // Returns an offset or pointer by OperandSource
+        template <int source>
+        uint16_t Operand( const DecodedInstruction &ins ) {
+            if constexpr ( source == SOURCE_X ) return X;
+            if constexpr ( source == SOURCE_Y ) return Y;
+            if constexpr ( source == SOURCE_IMM8 ) return ins.imm8;
+            if constexpr ( source == SOURCE_IMM16 ) return ins.imm16;
         }
 
-        // Load offset with immediate
-        uint16_t LoadOffsetIm( uint16_t segment, uint16_t offset ) {
-            return LoadOffset( segment, offset + Fetch() );
+        // Returns the linear address a register's load or store accesses
+        // Pointers are always followed into the stack segment
+        template <int reg, int mode>
+        uint16_t EffectiveAddress( const DecodedInstruction &ins ) {
+            constexpr RegisterLayout layout = registerLayouts[reg];
+
+            uint16_t offset = Operand<layout.offset>( ins );
+            if constexpr ( IsStackMode( mode ) )
+                offset += BP;
+            uint16_t address =
+                CalculateAddress( IsStackMode( mode ) ? SS : DS, offset );
+
+            if constexpr ( IsPointerMode( mode ) ) {
+                uint16_t pointer = memory->Read16( address );
+                address = CalculateAddress(
+                    SS, pointer + Operand<layout.pointer>( ins )
+                );
+            }
+            return address;
         }
 
-        // Load pointer offset value
-        uint16_t LoadPointerOffset(
-            uint16_t segment,
-            uint16_t offset,
-            uint16_t pointer
-        ) {
-            uint16_t address = Read16( segment, offset );
-            uint16_t value = Read16( SS, address + pointer );
-            GenericFlagSet( value );
-            return value;
-        }
+        // Loads a register
+        template <int reg, int mode>
+        void Load( const DecodedInstruction &ins ) {
+            uint16_t value;
+            if constexpr ( mode == MODE_IM )
+                value = ins.imm16;
+            else
+                value = memory->Read16( EffectiveAddress<reg, mode>( ins ) );
 
-        // Load pointer offset value with an immediate offset
-        uint16_t LoadPointerOffsetIm(
-            uint16_t segment,
-            uint16_t offset,
-            uint16_t pointer
-        ) {
-            return LoadPointerOffset( segment, offset + Fetch(), pointer );
-        }
-
-        // Load pointer offset value with an immediate pointer
-        uint16_t LoadPointerImOffset(
-            uint16_t segment,
-            uint16_t offset,
-            uint16_t pointer
-        ) {
-            return LoadPointerOffset( segment, offset, pointer + Fetch16() );
-        }
-
-        // Load pointer offset value with an immediate offset and pointer
-        uint16_t LoadPointerImOffsetIm(
-            uint16_t segment,
-            uint16_t offset,
-            uint16_t pointer
-        ) {
-            return LoadPointerOffset(
-                segment,
-                offset + Fetch(),
-                pointer + Fetch16()
-            );
+            AccessedRegister<reg>() = value;
+            GenericFlagSet( value );
         }
 
-        // Store offset value in memory
-        void StoreOffset( uint16_t segment, uint16_t offset, uint16_t value ) {
-            Write16( segment, offset, value );
-        }
-
-        // Store offset value in memory with an immediate offset
-        void StoreOffsetIm(
-            uint16_t segment,
-            uint16_t offset,
-            uint16_t value
-        ) {
-            StoreOffset( segment, offset + Fetch(), value );
-        }
-
-        // Store pointer offset value in memory
-        void StorePointerOffset(
-            uint16_t segment,
-            uint16_t offset,
-            uint16_t pointer,
-            uint16_t value
-        ) {
-            uint16_t address = Read16( segment, offset );
-            Write16( SS, address + pointer, value );
-        }
-
-        // Store pointer offset value in memory with an immediate offset
-        void StorePointerOffsetIm(
-            uint16_t segment,
-            uint16_t offset,
-            uint16_t pointer,
-            uint16_t value
-        ) {
-            StorePointerOffset( segment, offset + Fetch(), pointer, value );
-        }
-
-        // Store pointer offset value in memory with an immediate pointer
-        void StorePointerImOffset(
-            uint16_t segment,
-            uint16_t offset,
-            uint16_t pointer,
-            uint16_t value
-        ) {
-            StorePointerOffset( segment, offset, pointer + Fetch16(), value );
-        }
-
-        // Store pointer offset value in memory with an immediate offset and
-        // pointer
-        void StorePointerImOffsetIm(
-            uint16_t segment,
-            uint16_t offset,
-            uint16_t pointer,
-            uint16_t value
-        ) {
-            StorePointerOffset(
-                segment,
-                offset + Fetch(),
-                pointer + Fetch16(),
-                value
+        // Stores a register in memory
+        template <int reg, int mode>
+        void Store( const DecodedInstruction &ins ) {
+            memory->Write16(
+                EffectiveAddress<reg, mode>( ins ), AccessedRegister<reg>()
             );
         }
 
@@ -309,6 +511,201 @@ namespace btp {
             SP += 2;
             return value;
         }
+
+        // Jumps, checking backward jumps for an idle loop
+        void Jump( const DecodedInstruction &ins ) {
+            IP += (int8_t)ins.imm8;
+            if ( (int8_t)ins.imm8 < 0 )
+                CheckIdleLoop( ins );
+        }
+
+        // Ends the slice if the backward JMP just run closed an idle loop:
+        // the loop is pure and one iteration left the state unchanged, so
+        // every further iteration is the same until an event
+        void CheckIdleLoop( const DecodedInstruction &jump );
+
+        // Returns true if a loop of the instructions from `start` up to the
+        // JMP at `jump` cannot write memory or change CS, and then counts the
+        // cycles and instructions of an iteration
+        bool AnalyzeLoop( uint16_t start, uint16_t jump );
+
+        // Skips whole iterations of the idle loop CheckIdleLoop() found,
+        // staying within the budget, and resumes the slice. Returns false if
+        // the slice ended for another reason.
+        bool SkipIdleLoop( RunResult &result, uint32_t budget ) {
+            if ( !idling )
+                return false;
+
+            idling = false;
+            cycleLimit = budget;
+            if ( result.cycles < budget ) {
+                uint32_t loops = ( budget - result.cycles ) / idleCycles;
+                result.cycles += loops * idleCycles;
+                result.instructions += loops * idleInstructions;
+                skippedCycles += (uint64_t)loops * idleCycles;
+            }
+            return true;
+        }
+
+        // Returns true if a vector's CS:IP is not 0:0
+        bool IsVectorInstalled( uint8_t vector ) {
+            uint16_t entry = InterruptEntry( vector );
+            return memory->Read16( entry ) | memory->Read16( entry + 2 );
+        }
+
+        // Runs INT: enters a vector's handler, or halts on the INT like an
+        // undefined opcode if none is installed
+        void SoftwareInterrupt( const DecodedInstruction &ins ) {
+            if ( IsVectorInstalled( ins.imm8 ) ) {
+                EnterInterrupt( ins.imm8 );
+                return;
+            }
+            IP -= ins.length;
+            halted = true;
+            cycleLimit = 0;
+        }
+
+        // Pushes the flags, CS and IP, masks interrupts and jumps to a
+        // vector's handler. The handler may change what an idle loop polls,
+        // so the loop has to come back to the same state again.
+        void EnterInterrupt( uint8_t vector ) {
+            idleStart = -1;
+            Flags pushed = GetFlags();
+            Push16( pushed.value );
+            Push16( CS );
+            Push16( IP );
+
+            flags.I = 1;
+            uint16_t entry = InterruptEntry( vector );
+            CS = memory->Read16( entry );
+            IP = memory->Read16( entry + 2 );
+        }
+
+        // Pops IP, CS and the flags, ending the slice if that unmasked a
+        // pending interrupt
+        void ReturnFromInterrupt() {
+            IP = Pop16();
+            CS = Pop16();
+            SetFlags( { (uint8_t)Pop16() } );
+            if ( pendingInterrupts && !flags.I )
+                cycleLimit = 0;
+        }
+
+        // Stops until an interrupt is pending, which it may already be
+        void Wait() {
+            if ( pendingInterrupts == 0 ) {
+                waiting = true;
+                cycleLimit = 0;
+            }
+        }
+
+        // Wakes the CPU if any interrupt is pending and takes the lowest one
+        // unless IF is set. Returns true if it took one.
+        bool ServiceInterrupts() {
+            if ( pendingInterrupts == 0 )
+                return false;
+
+            waiting = false;
+            if ( flags.I )
+                return false;
+
+            uint8_t vector = __builtin_ctz( pendingInterrupts );
+            pendingInterrupts &= pendingInterrupts - 1;
+            EnterInterrupt( vector );
+            return true;
+        }
+
+        // Returns the cycles until the timer runs out, restarting it if the
+        // program changed TIMER_PERIOD
+        uint32_t UntilTimer() {
+            uint16_t period = memory->Read16( TIMER_PERIOD );
+            if ( period != timerPeriod ) {
+                timerPeriod = period;
+                timerCycles = 0;
+            }
+            if ( timerPeriod == 0 )
+                return UINT32_MAX;
+            return timerPeriod - timerCycles;
+        }
+
+        // Counts cycles towards the timer, raising IRQ_TIMER when it runs out
+        void AdvanceTimer( uint32_t cycles ) {
+            if ( timerPeriod == 0 )
+                return;
+
+            timerCycles += cycles;
+            if ( timerCycles >= timerPeriod ) {
+                timerCycles %= timerPeriod;
+                RaiseInterrupt( IRQ_TIMER );
+            }
+        }
+
+        // Works out why RunCycles() stopped at the end of a slice
+        int SliceEnd( uint32_t cycles, uint32_t budget ) const {
+            if ( halted )
+                return STOP_HALT;
+            if ( waiting )
+                return STOP_WAIT;
+            return cycles < budget ? STOP_EVENT : STOP_BUDGET;
+        }
+
+        // Runs `run( cycles )`, a RunCycles(), in slices that end at the
+        // budget or the next timer event. Between slices, interrupts are
+        // taken, and while the CPU waits the slice is skipped instead.
+        template <typename Run>
+        RunResult RunEvents( uint32_t budget, Run run ) {
+            RunResult result = { 0, 0, STOP_BUDGET };
+            bool resuming = true; // Ignore a breakpoint at the starting CS:IP
+
+            while ( !halted && result.cycles < budget ) {
+                if ( ServiceInterrupts() )
+                    resuming = false;
+                if ( !resuming && breakpoints[CalculateAddress( CS, IP )] ) {
+                    result.reason = STOP_BREAKPOINT;
+                    break;
+                }
+                resuming = false;
+                if ( watcherSlot != -1 )
+                    memory->WatchPage( INTERRUPT_PAGE, watcherSlot );
+
+                uint32_t limit =
+                    std::min( budget - result.cycles, UntilTimer() );
+                RunResult slice = { limit, 0, STOP_BUDGET };
+                if ( !waiting )
+                    slice = run( limit );
+
+                result.cycles += slice.cycles;
+                result.instructions += slice.instructions;
+                AdvanceTimer( slice.cycles );
+                if (
+                    slice.reason == STOP_HALT ||
+                    slice.reason == STOP_BREAKPOINT
+                ) {
+                    result.reason = slice.reason;
+                    break;
+                }
+            }
+
+            if ( halted )
+                result.reason = STOP_HALT;
+            return result;
+        }
+
+        // Runs a frame like RunFrame(), slicing it with `run`
+        template <typename Run>
+        RunResult RunFrameWith( Run run ) {
+            RaiseInterrupt( IRQ_VBLANK );
+
+            uint32_t budget = CYCLES_PER_FRAME - cycleDebt;
+            RunResult result = RunEvents( budget, run );
+
+            if ( result.reason == STOP_BUDGET )
+                cycleDebt = result.cycles - budget;
+            else
+                cycleDebt = 0;
+
+            return result;
+        }
     };
 
 }
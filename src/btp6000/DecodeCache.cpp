@@ -0,0 +1,110 @@
+/*
+* Copyright © 2025 Micro-16 Team
+* 
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the “Software”), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+* 
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+* 
+* THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#include "Btp.hpp"
+
+namespace btp {
+
+// Frees all pages
+DecodeCache::~DecodeCache() {
+    if ( memory != nullptr && watcherSlot != -1 )
+        memory->RemoveWatcher( watcherSlot );
+
+    for ( Page *page : pages )
+        delete page;
+}
+
+// Sets up the memory and starts watching it for writes
+void DecodeCache::SetMemory( Bob3k *memory ) {
+    if ( this->memory != nullptr && watcherSlot != -1 )
+        this->memory->RemoveWatcher( watcherSlot );
+
+    this->memory = memory;
+    watcherSlot = memory->AddWatcher( this );
+    Flush();
+}
+
+// Forgets every decoded instruction
+void DecodeCache::Flush() {
+    for ( Page *&page : pages ) {
+        delete page;
+        page = nullptr;
+    }
+}
+
+// Forgets a page when it is written to
+void DecodeCache::PageWritten( uint8_t page ) {
+    if ( pages[page] != nullptr )
+        *pages[page] = Page();
+
+    // Instructions at the end of the previous page may reach into this one
+    Page *previous = pages[(uint8_t)( page - 1 )];
+    if ( previous != nullptr ) {
+        for (
+            int i = BOB3K_PAGE_SIZE - MAX_INSTRUCTION_LENGTH + 1;
+            i < BOB3K_PAGE_SIZE;
+            i++
+        )
+            previous->entries[i].length = 0;
+    }
+}
+
+// Decodes the instruction at a linear address into its entry and watches its
+// pages, or into `uncached` if it is read through a device or there is no
+// watcher slot to hear about writes to it
+const DecodedInstruction &DecodeCache::Decode(
+    DecodedInstruction &entry,
+    uint16_t address
+) {
+    uint8_t opcode = memory->Read( address );
+    const InstructionFormat &format = instructionFormats[opcode];
+
+    DecodedInstruction instruction = {
+        opcode, 1, instructionCycles[opcode], 0, 0
+    };
+
+    if ( format.imm8 )
+        instruction.imm8 = memory->Read( address + instruction.length++ );
+    if ( format.imm16 ) {
+        instruction.imm16 = memory->Read16( address + instruction.length );
+        instruction.length += 2;
+    }
+
+    uint8_t firstPage = address >> 8;
+    uint8_t lastPage = (uint16_t)( address + instruction.length - 1 ) >> 8;
+    if (
+        watcherSlot == -1 ||
+        memory->IsReadMapped( firstPage ) ||
+        memory->IsReadMapped( lastPage )
+    ) {
+        uncached = instruction;
+        return uncached;
+    }
+
+    // Watch every page the instruction touches
+    memory->WatchPage( firstPage, watcherSlot );
+    memory->WatchPage( lastPage, watcherSlot );
+    entry = instruction;
+    return entry;
+}
+
+}
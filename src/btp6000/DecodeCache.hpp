@@ -0,0 +1,107 @@
+/*
+* Copyright © 2025 Micro-16 Team
+* 
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the “Software”), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+* 
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+* 
+* THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#ifndef DECODECACHE_HPP
+#define DECODECACHE_HPP
+
+#include "stdint.h"
+
+#include "../bob3000/Bob.hpp"
+
+// Longest instruction: opcode, offset and pointer immediates
+#define MAX_INSTRUCTION_LENGTH 4
+
+// The Better Than Pico 6000 namespace
+namespace btp {
+
+// An instruction with its immediates already pulled out of memory
+struct DecodedInstruction {
+    uint8_t opcode;
+    uint8_t length; // Bytes including the opcode, 0 if not decoded yet
+    uint8_t cycles;
+    uint8_t imm8;   // Immediate offset or jump distance
+    uint16_t imm16; // Immediate value or pointer
+};
+
+// Caches decoded instructions by linear address so that hot code is only
+// decoded once. A page of entries is allocated the first time code runs from
+// it and is thrown away as soon as that page of memory is written to, which
+// keeps self-modifying code correct. Code read through a device is decoded
+// again every time it runs, since the device may return other bytes, and so
+// is all code if the memory had no watcher slot left for the cache.
+class DecodeCache : public Bob3kWatcher {
+public:
+    // Empty constructor
+    DecodeCache() {}
+
+    // Frees all pages
+    ~DecodeCache();
+
+    // Pages are owned by the cache
+    DecodeCache( const DecodeCache & ) = delete;
+    DecodeCache &operator=( const DecodeCache & ) = delete;
+
+    // Sets up the memory and starts watching it for writes
+    void SetMemory( Bob3k *memory );
+
+    // Returns the decoded instruction at a linear address
+    const DecodedInstruction &Lookup( uint16_t address ) {
+        Page *page = pages[address >> 8];
+        if ( page == nullptr )
+            page = pages[address >> 8] = new Page();
+
+        DecodedInstruction &instruction = page->entries[address & 0xFF];
+        if ( instruction.length == 0 )
+            return Decode( instruction, address );
+
+        return instruction;
+    }
+
+    // Forgets every decoded instruction
+    void Flush();
+
+    // Forgets a page when it is written to
+    void PageWritten( uint8_t page ) override;
+
+private:
+    // 256 decoded instructions, one for each byte of a page
+    struct Page {
+        DecodedInstruction entries[BOB3K_PAGE_SIZE] = {};
+    };
+
+    Bob3k *memory = nullptr;
+    int watcherSlot = -1;
+    Page *pages[BOB3K_PAGE_COUNT] = {};
+    DecodedInstruction uncached; // Last instruction that was not cached
+
+    // Decodes the instruction at a linear address into its entry and watches
+    // its pages, or into `uncached` if it is read through a device or there
+    // is no watcher slot
+    const DecodedInstruction &Decode(
+        DecodedInstruction &entry,
+        uint16_t address
+    );
+};
+
+}
+
+#endif
@@ -0,0 +1,122 @@
+/*
+* Copyright © 2025 Micro-16 Team
+* 
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the “Software”), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+* 
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+* 
+* THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+// Instruction handlers shared by the dispatch cores in Btp.cpp
+//
+// There is deliberately no include guard. Before including this file, define
+// HANDLER( name, opcode, ... ) to turn each entry into a switch case or a
+// threaded label. `name` is a unique label for the handler, `opcode` a
+// constant expression and the body (variadic, since template arguments
+// contain commas) runs with `ins` holding the decoded instruction and IP
+// already past it.
+
+// The loads and stores of register `r`, one per addressing mode, with the
+// opcodes taken from registerLayouts
+#define ACCESS_HANDLERS( r )                                                \
+    HANDLER( LD##r##_IM,  LoadOpcode( REG_##r, MODE_IM ),                   \
+             Load<REG_##r, MODE_IM>( ins ) )                                \
+    HANDLER( LD##r##_SO,  LoadOpcode( REG_##r, MODE_SO ),                   \
+             Load<REG_##r, MODE_SO>( ins ) )                                \
+    HANDLER( LD##r##_SPO, LoadOpcode( REG_##r, MODE_SPO ),                  \
+             Load<REG_##r, MODE_SPO>( ins ) )                               \
+    HANDLER( LD##r##_DO,  LoadOpcode( REG_##r, MODE_DO ),                   \
+             Load<REG_##r, MODE_DO>( ins ) )                                \
+    HANDLER( LD##r##_DPO, LoadOpcode( REG_##r, MODE_DPO ),                  \
+             Load<REG_##r, MODE_DPO>( ins ) )                               \
+    HANDLER( ST##r##_SO,  StoreOpcode( REG_##r, MODE_SO ),                  \
+             Store<REG_##r, MODE_SO>( ins ) )                               \
+    HANDLER( ST##r##_SPO, StoreOpcode( REG_##r, MODE_SPO ),                 \
+             Store<REG_##r, MODE_SPO>( ins ) )                              \
+    HANDLER( ST##r##_DO,  StoreOpcode( REG_##r, MODE_DO ),                  \
+             Store<REG_##r, MODE_DO>( ins ) )                               \
+    HANDLER( ST##r##_DPO, StoreOpcode( REG_##r, MODE_DPO ),                 \
+             Store<REG_##r, MODE_DPO>( ins ) )
+
+// Handlers whose opcode is INS_<name>
+#define OPCODE_HANDLER( name, ... ) HANDLER( name, INS_##name, __VA_ARGS__ )
+
+// LDA and STA
+ACCESS_HANDLERS( A )
+
+// TA-X
+OPCODE_HANDLER( TAB,    B.value = A.value )
+OPCODE_HANDLER( TAX,    X = A.value )
+OPCODE_HANDLER( TAY,    Y = A.value )
+OPCODE_HANDLER( TASS,   SS = A.value )
+OPCODE_HANDLER( TACS,   CS = A.value )
+OPCODE_HANDLER( TADS,   DS = A.value )
+
+// LDB and STB
+ACCESS_HANDLERS( B )
+
+// TB-X
+OPCODE_HANDLER( TBA,    A.value = B.value )
+OPCODE_HANDLER( TBX,    X = B.value )
+OPCODE_HANDLER( TBY,    Y = B.value )
+OPCODE_HANDLER( TBSS,   SS = B.value )
+OPCODE_HANDLER( TBCS,   CS = B.value )
+OPCODE_HANDLER( TBDS,   DS = B.value )
+
+// LDX and STX
+ACCESS_HANDLERS( X )
+
+// TX-X
+OPCODE_HANDLER( TXA,    A.value = X )
+OPCODE_HANDLER( TXB,    B.value = X )
+OPCODE_HANDLER( TXY,    Y = X )
+OPCODE_HANDLER( TXSS,   SS = X )
+OPCODE_HANDLER( TXCS,   CS = X )
+OPCODE_HANDLER( TXDS,   DS = X )
+
+// LDY and STY
+ACCESS_HANDLERS( Y )
+
+// TY-X
+OPCODE_HANDLER( TYA,    A.value = Y )
+OPCODE_HANDLER( TYB,    B.value = Y )
+OPCODE_HANDLER( TYX,    X = Y )
+OPCODE_HANDLER( TYSS,   SS = Y )
+OPCODE_HANDLER( TYCS,   CS = Y )
+OPCODE_HANDLER( TYDS,   DS = Y )
+
+// Stack operations
+OPCODE_HANDLER( PUSHA,  Push16( A.value ) )
+OPCODE_HANDLER( POPA,   A.value = Pop16() )
+OPCODE_HANDLER( PUSHB,  Push16( B.value ) )
+OPCODE_HANDLER( POPB,   B.value = Pop16() )
+OPCODE_HANDLER( PUSHX,  Push16( X ) )
+OPCODE_HANDLER( POPX,   X = Pop16() )
+OPCODE_HANDLER( PUSHY,  Push16( Y ) )
+OPCODE_HANDLER( POPY,   Y = Pop16() )
+OPCODE_HANDLER( ENTER,  Push16( BP ); BP = SP )
+OPCODE_HANDLER( LEAVE,  SP = BP; BP = Pop16() )
+
+// JMP
+OPCODE_HANDLER( JMP,    Jump( ins ) )
+
+// Interrupts
+OPCODE_HANDLER( INT,    SoftwareInterrupt( ins ) )
+OPCODE_HANDLER( RTI,    ReturnFromInterrupt() )
+OPCODE_HANDLER( WAI,    Wait() )
+
+#undef OPCODE_HANDLER
+#undef ACCESS_HANDLERS
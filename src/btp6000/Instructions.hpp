@@ -137,11 +137,35 @@ enum Instructions {
     INS_LJMP    = 0xC6, // Long jump,          sets IP
 
     // Interrupts
-    INS_INT     = 0x00, // Interrupt 
-                        //     push flags and IP, then reference the
-                        //     interrupt jump table, and jump to the interrupt
-                        //     handler
-    INS_RTI     = 0x01, // Return from interrupt (pop IP and flags)
+    INS_INT     = 0x00, // Interrupt (vector = immediate)
+                        //     push flags, CS and IP, set IF, then reference
+                        //     the interrupt jump table, and jump to the
+                        //     interrupt handler
+    INS_RTI     = 0x01, // Return from interrupt (pop IP, CS and flags)
+    INS_WAI     = 0x02, // Wait for an interrupt
+};
+
+// Number of clock cycles each instruction takes, indexed by opcode
+// Roughly one cycle per byte fetched and two per word of memory accessed.
+// Undefined opcodes cost a single cycle.
+const uint8_t instructionCycles[0x100] = {
+//  x0 x1 x2 x3 x4 x5 x6 x7 x8 x9 xA xB xC xD xE xF
+     8, 5, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, // 0x
+     1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, // 1x
+     1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, // 2x
+     1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, // 3x
+     1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, // 4x
+     3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 5, 3, 1, 1, 1, 1, // 5x
+     1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, // 6x
+     1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, // 7x
+     3, 4, 6, 4, 6, 4, 6, 4, 6, 1, 1, 1, 1, 1, 1, 1, // 8x
+     3, 3, 7, 3, 7, 3, 7, 3, 7, 1, 1, 1, 1, 1, 1, 1, // 9x
+     3, 3, 5, 3, 5, 3, 5, 3, 5, 1, 1, 1, 1, 1, 1, 1, // Ax
+     3, 4, 8, 4, 8, 4, 8, 4, 8, 1, 1, 1, 1, 1, 1, 1, // Bx
+     1, 2, 2, 2, 2, 2, 3, 1, 1, 1, 1, 1, 1, 1, 1, 1, // Cx
+     1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, // Dx
+     1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, // Ex
+     1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, // Fx
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,661 @@
+/*
+* Copyright © 2025 Micro-16 Team
+* 
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the “Software”), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+* 
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+* 
+* THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#include "Jit.hpp"
+
+#ifdef BTP_JIT
+
+#include <initializer_list>
+
+#include "string.h"
+#include "sys/mman.h"
+
+namespace btp {
+
+// x86-64 register numbers
+enum HostRegister {
+    RAX, RCX, RDX, RBX, RSP, RBP, RSI, RDI,
+};
+
+// Condition codes for Jcc
+enum Condition {
+    COND_AE = 0x3, // Above or equal (unsigned)
+    COND_Z  = 0x4, // Zero
+    COND_NZ = 0x5, // Not zero
+};
+
+// Appends x86-64 machine code to a buffer
+// rbx always holds the CPU, rbp the Jit, r12d the instruction count, r13d
+// the cycle count and r14d the cycle budget
+class Emitter {
+public:
+    // Constructor
+    Emitter( uint8_t *code ) : code( code ) {}
+
+    // Returns where the next byte goes
+    uint8_t *Position() const {
+        return code;
+    }
+
+    // Appends raw bytes
+    void Bytes( std::initializer_list<uint8_t> bytes ) {
+        for ( uint8_t byte : bytes )
+            *code++ = byte;
+    }
+
+    // Appends a little endian value
+    template <typename T>
+    void Value( T value ) {
+        memcpy( code, &value, sizeof( T ) );
+        code += sizeof( T );
+    }
+
+    // movzx r32, word [rbx+disp]
+    void LoadField( int reg, int32_t disp ) {
+        Bytes( { 0x0F, 0xB7, (uint8_t)( 0x83 | reg << 3 ) } );
+        Value( disp );
+    }
+
+    // mov word [rbx+disp], r16
+    void StoreField( int32_t disp, int reg ) {
+        Bytes( { 0x66, 0x89, (uint8_t)( 0x83 | reg << 3 ) } );
+        Value( disp );
+    }
+
+    // mov word [rbx+disp], imm16
+    void StoreFieldImmediate( int32_t disp, uint16_t value ) {
+        Bytes( { 0x66, 0xC7, 0x83 } );
+        Value( disp );
+        Value( value );
+    }
+
+    // add word [rbx+disp], imm16 (also subtracts, since it wraps)
+    void AddFieldImmediate( int32_t disp, uint16_t value ) {
+        Bytes( { 0x66, 0x81, 0x83 } );
+        Value( disp );
+        Value( value );
+    }
+
+    // and byte [rbx+disp], imm8
+    void AndFieldByte( int32_t disp, uint8_t value ) {
+        Bytes( { 0x80, 0xA3 } );
+        Value( disp );
+        Value( value );
+    }
+
+    // or byte [rbx+disp], imm8
+    void OrFieldByte( int32_t disp, uint8_t value ) {
+        Bytes( { 0x80, 0x8B } );
+        Value( disp );
+        Value( value );
+    }
+
+    // or byte [rbx+disp], cl
+    void OrFieldCl( int32_t disp ) {
+        Bytes( { 0x08, 0x8B } );
+        Value( disp );
+    }
+
+    // shl r32, imm8
+    void ShiftLeft( int reg, uint8_t count ) {
+        Bytes( { 0xC1, (uint8_t)( 0xE0 | reg ), count } );
+    }
+
+    // add r32, r32
+    void Add( int dst, int src ) {
+        Bytes( { 0x01, (uint8_t)( 0xC0 | src << 3 | dst ) } );
+    }
+
+    // add r32, imm32
+    void AddImmediate( int reg, uint32_t value ) {
+        Bytes( { 0x81, (uint8_t)( 0xC0 | reg ) } );
+        Value( value );
+    }
+
+    // mov r32, r32
+    void Move( int dst, int src ) {
+        Bytes( { 0x89, (uint8_t)( 0xC0 | src << 3 | dst ) } );
+    }
+
+    // movzx r32, r16
+    void ZeroExtend16( int reg ) {
+        Bytes( { 0x0F, 0xB7, (uint8_t)( 0xC0 | reg << 3 | reg ) } );
+    }
+
+    // Calls a helper with the Jit as the first argument
+    void CallHelper( const void *function ) {
+        Bytes( { 0x48, 0x89, 0xEF } ); // mov rdi, rbp
+        Bytes( { 0x48, 0xB8 } );       // mov rax, imm64
+        Value( (uint64_t)function );
+        Bytes( { 0xFF, 0xD0 } );       // call rax
+    }
+
+    // Adds to the cycle and instruction counters
+    void Count( uint32_t cycles, uint32_t instructions ) {
+        Bytes( { 0x41, 0x81, 0xC5 } ); // add r13d, imm32
+        Value( cycles );
+        Bytes( { 0x41, 0x81, 0xC4 } ); // add r12d, imm32
+        Value( instructions );
+    }
+
+    // jmp rel32
+    void Jump( const uint8_t *target ) {
+        Bytes( { 0xE9 } );
+        Value( (int32_t)( target - ( code + 4 ) ) );
+    }
+
+    // jcc rel32
+    void JumpIf( int condition, const uint8_t *target ) {
+        Bytes( { 0x0F, (uint8_t)( 0x80 | condition ) } );
+        Value( (int32_t)( target - ( code + 4 ) ) );
+    }
+
+    // jcc rel32 to a target that is patched in later with Land()
+    uint8_t *JumpIfForward( int condition ) {
+        Bytes( { 0x0F, (uint8_t)( 0x80 | condition ), 0, 0, 0, 0 } );
+        return code - 4;
+    }
+
+    // Points a forward jump at the current position
+    void Land( uint8_t *patch ) {
+        int32_t distance = (int32_t)( code - ( patch + 4 ) );
+        memcpy( patch, &distance, sizeof( distance ) );
+    }
+
+private:
+    uint8_t *code;
+};
+
+// Attaches the recompiler to a CPU, whose memory must already be set
+Jit::Jit( BetterThanPico *cpu ) : cpu( cpu ), memory( cpu->memory ) {
+    watcherSlot = memory->AddWatcher( this );
+    blocks = new void*[BOB3K_SIZE]();
+
+    // Register offsets
+    uint8_t *base = (uint8_t*)cpu;
+    offsetA     = (uint8_t*)&cpu->A.value   - base;
+    offsetB     = (uint8_t*)&cpu->B.value   - base;
+    offsetX     = (uint8_t*)&cpu->X         - base;
+    offsetY     = (uint8_t*)&cpu->Y         - base;
+    offsetIP    = (uint8_t*)&cpu->IP        - base;
+    offsetSP    = (uint8_t*)&cpu->SP        - base;
+    offsetBP    = (uint8_t*)&cpu->BP        - base;
+    offsetSS    = (uint8_t*)&cpu->SS        - base;
+    offsetCS    = (uint8_t*)&cpu->CS        - base;
+    offsetDS    = (uint8_t*)&cpu->DS        - base;
+    offsetFlags = (uint8_t*)&cpu->flags     - base;
+
+    // Blocks could not be dropped when their code is overwritten without a
+    // watcher slot, so everything is left to the interpreter
+    if ( watcherSlot == -1 ) {
+        printf( "JIT: No watcher slot left, interpreting instead!\n" );
+        buffer = nullptr;
+        return;
+    }
+
+    buffer = (uint8_t*)mmap(
+        nullptr, JIT_BUFFER_SIZE,
+        PROT_READ | PROT_WRITE | PROT_EXEC,
+        MAP_PRIVATE | MAP_ANONYMOUS,
+        -1, 0
+    );
+    if ( buffer == MAP_FAILED ) {
+        printf( "JIT: Failed to map executable memory!\n" );
+        buffer = nullptr;
+        return;
+    }
+
+    EmitStubs();
+}
+
+// Frees the executable memory and block table
+Jit::~Jit() {
+    if ( watcherSlot != -1 )
+        memory->RemoveWatcher( watcherSlot );
+    if ( buffer != nullptr )
+        munmap( buffer, JIT_BUFFER_SIZE );
+
+    delete[] blocks;
+}
+
+// Emits the entry and exit stubs at the start of the buffer
+void Jit::EmitStubs() {
+    Emitter emit( buffer );
+
+    // uint64_t entry( cpu = rdi, jit = rsi, code = rdx, budget = ecx )
+    entry = (Entry)emit.Position();
+    emit.Bytes( { 0x53, 0x55 } );             // push rbx; push rbp
+    emit.Bytes( { 0x41, 0x54, 0x41, 0x55 } ); // push r12; push r13
+    emit.Bytes( { 0x41, 0x56, 0x41, 0x57 } ); // push r14; push r15
+    emit.Bytes( { 0x48, 0x83, 0xEC, 0x08 } ); // sub rsp, 8 (alignment)
+    emit.Bytes( { 0x48, 0x89, 0xFB } );       // mov rbx, rdi
+    emit.Bytes( { 0x48, 0x89, 0xF5 } );       // mov rbp, rsi
+    emit.Bytes( { 0x41, 0x89, 0xCE } );       // mov r14d, ecx
+    emit.Bytes( { 0x45, 0x31, 0xED } );       // xor r13d, r13d
+    emit.Bytes( { 0x45, 0x31, 0xE4 } );       // xor r12d, r12d
+    emit.Bytes( { 0xFF, 0xE2 } );             // jmp rdx
+
+    // Returns r13d | r12d << 32
+    exitStub = emit.Position();
+    emit.Bytes( { 0x44, 0x89, 0xE8 } );       // mov eax, r13d
+    emit.Bytes( { 0x44, 0x89, 0xE2 } );       // mov edx, r12d
+    emit.Bytes( { 0x48, 0xC1, 0xE2, 0x20 } ); // shl rdx, 32
+    emit.Bytes( { 0x48, 0x09, 0xD0 } );       // or rax, rdx
+    emit.Bytes( { 0x48, 0x83, 0xC4, 0x08 } ); // add rsp, 8
+    emit.Bytes( { 0x41, 0x5F, 0x41, 0x5E } ); // pop r15; pop r14
+    emit.Bytes( { 0x41, 0x5D, 0x41, 0x5C } ); // pop r13; pop r12
+    emit.Bytes( { 0x5D, 0x5B, 0xC3 } );       // pop rbp; pop rbx; ret
+
+    bufferUsed = emit.Position() - buffer;
+}
+
+// Drops every translated block
+void Jit::Flush() {
+    memset( blocks, 0, BOB3K_SIZE * sizeof( void* ) );
+    for ( std::vector<uint16_t> &list : pageBlocks )
+        list.clear();
+
+    if ( buffer != nullptr )
+        EmitStubs();
+    invalidations++;
+    readDevices = memory->HasReadDevices();
+}
+
+// Drops the blocks in a page when it is written to
+void Jit::PageWritten( uint8_t page ) {
+    for ( uint16_t start : pageBlocks[page] )
+        blocks[start] = nullptr;
+
+    pageBlocks[page].clear();
+    invalidations++;
+}
+
+// Same as BetterThanPico::RunCycles(), but a whole block runs before the
+// budget is checked
+RunResult Jit::RunCycles( uint32_t budget ) {
+    if ( buffer == nullptr || cpu->HasBreakpoints() || cpu->observed )
+        return cpu->RunCycles( budget );
+    if ( memory->HasReadDevices() != readDevices )
+        Flush();
+
+    RunResult result = { 0, 0, STOP_BUDGET };
+    cpu->cycleLimit = cpu->waiting ? 0 : budget;
+    cpu->idleStart = -1;
+
+    while ( true ) {
+        if ( cpu->halted ) {
+            result.reason = STOP_HALT;
+            break;
+        }
+        if ( result.cycles >= cpu->cycleLimit ) {
+            result.reason = cpu->SliceEnd( result.cycles, budget );
+            break;
+        }
+
+        uint16_t address = cpu->CalculateAddress( cpu->CS, cpu->IP );
+        void *code = blocks[address];
+        if ( code == nullptr )
+            code = Translate( address );
+
+        if ( code != nullptr ) {
+            uint64_t counts =
+                entry( cpu, this, code, cpu->cycleLimit - result.cycles );
+            result.cycles += (uint32_t)counts;
+            result.instructions += (uint32_t)( counts >> 32 );
+        }
+        else {
+            // Not translatable, interpret it
+            result.cycles += cpu->Execute();
+            result.instructions++;
+        }
+    }
+
+    return result;
+}
+
+// Same as BetterThanPico::RunFrame(), with the slices run by the recompiler
+RunResult Jit::RunFrame() {
+    if ( buffer == nullptr || cpu->HasBreakpoints() || cpu->observed )
+        return cpu->RunFrame();
+
+    return cpu->RunFrameWith( [this]( uint32_t budget ) {
+        return RunCycles( budget );
+    } );
+}
+
+// Reads a word for native code
+uint32_t Jit::Read16( Jit *jit, uint32_t address ) {
+    return jit->memory->Read16( address );
+}
+
+// Reads a word for native code straight from RAM
+uint32_t Jit::ReadRam16( Jit *jit, uint32_t address ) {
+    const uint8_t *data = jit->memory->data();
+    if ( address == BOB3K_SIZE - 1 ) // Wrap around the end of memory
+        return data[address] | ( data[0] << 8 );
+    return *(uint16_t*)( data + address );
+}
+
+// Writes a word for native code, returns non-zero if any block was dropped
+// so that the running block can bail out in case it was one of them, or if
+// the write ended the slice
+uint32_t Jit::Write16( Jit *jit, uint32_t address, uint32_t value ) {
+    uint32_t invalidations = jit->invalidations;
+    jit->memory->Write16( address, value );
+    return
+        jit->invalidations != invalidations || jit->cpu->cycleLimit == 0;
+}
+
+// Translates the block starting at a linear address
+void *Jit::Translate( uint16_t start ) {
+    if ( bufferUsed + JIT_MAX_BLOCK_CODE > JIT_BUFFER_SIZE )
+        Flush();
+
+    uint8_t *code = buffer + bufferUsed;
+    Emitter emit( code );
+    const void *read = readDevices ? (void*)Read16 : (void*)ReadRam16;
+
+    // Registers of the A, B, X and Y instruction families
+    const int32_t familyRegisters[4] = { offsetX, offsetY, offsetA, offsetB };
+
+    uint16_t address = start;      // Linear address of the next instruction
+    uint16_t ipDelta = 0;          // What IP has advanced by so far
+    uint32_t cycles = 0, count = 0;
+    bool ended = false;
+
+    // Leaves the block with IP, cycles and instructions up to date
+    auto emitExit = [&]() {
+        if ( ipDelta != 0 )
+            emit.AddFieldImmediate( offsetIP, ipDelta );
+        emit.Count( cycles, count );
+        emit.Jump( exitStub );
+    };
+
+    // Leaves the block and continues at a linear address if it has been
+    // translated and the budget allows it
+    auto emitChain = [&]( uint16_t target ) {
+        if ( ipDelta != 0 )
+            emit.AddFieldImmediate( offsetIP, ipDelta );
+        emit.Count( cycles, count );
+        emit.Bytes( { 0x45, 0x39, 0xF5 } ); // cmp r13d, r14d
+        emit.JumpIf( COND_AE, exitStub );
+        emit.Bytes( { 0x48, 0xB8 } );       // mov rax, &blocks[target]
+        emit.Value( (uint64_t)&blocks[target] );
+        emit.Bytes( { 0x48, 0x8B, 0x00 } ); // mov rax, [rax]
+        emit.Bytes( { 0x48, 0x85, 0xC0 } ); // test rax, rax
+        emit.JumpIf( COND_Z, exitStub );
+        emit.Bytes( { 0xFF, 0xE0 } );       // jmp rax
+    };
+
+    // Leaves the block if the write helper reported dropped blocks
+    auto emitWriteCheck = [&]() {
+        emit.Bytes( { 0x85, 0xC0 } );       // test eax, eax
+        uint8_t *skip = emit.JumpIfForward( COND_Z );
+        emitExit();
+        emit.Land( skip );
+    };
+
+    // esi = ( segment << 4 ) + base + index + immediate
+    auto emitAddress = [&](
+        int32_t segment, int32_t base, int32_t index, uint32_t immediate
+    ) {
+        emit.LoadField( RSI, segment );
+        emit.ShiftLeft( RSI, 4 );
+        if ( base != -1 ) {
+            emit.LoadField( RAX, base );
+            emit.Add( RSI, RAX );
+        }
+        if ( index != -1 ) {
+            emit.LoadField( RAX, index );
+            emit.Add( RSI, RAX );
+        }
+        if ( immediate != 0 )
+            emit.AddImmediate( RSI, immediate );
+        emit.ZeroExtend16( RSI );
+    };
+
+    // esi = ( SS << 4 ) + eax + pointer
+    auto emitPointerAddress = [&]( int32_t pointer, uint16_t immediate ) {
+        emit.Move( RSI, RAX );
+        emit.LoadField( RAX, offsetSS );
+        emit.ShiftLeft( RAX, 4 );
+        emit.Add( RSI, RAX );
+        if ( pointer != -1 ) {
+            emit.LoadField( RAX, pointer );
+            emit.Add( RSI, RAX );
+        }
+        if ( immediate != 0 )
+            emit.AddImmediate( RSI, immediate );
+        emit.ZeroExtend16( RSI );
+    };
+
+    // Sets Z and N from ax, like GenericFlagSet()
+    auto emitFlags = [&]() {
+        emit.Bytes( { 0x66, 0x85, 0xC0 } ); // test ax, ax
+        emit.Bytes( { 0x0F, 0x94, 0xC1 } ); // sete cl
+        emit.Bytes( { 0x00, 0xC9 } );       // add cl, cl
+        emit.Move( RDX, RAX );
+        emit.Bytes( { 0xC1, 0xEA, 0x0F } ); // shr edx, 15
+        emit.ShiftLeft( RDX, 3 );
+        emit.Bytes( { 0x09, 0xD1 } );       // or ecx, edx
+        emit.AndFieldByte( offsetFlags, 0xF5 );
+        emit.OrFieldCl( offsetFlags );
+    };
+
+    // esi = SS:SP
+    auto emitStackAddress = [&]() {
+        emitAddress( offsetSS, offsetSP, -1, 0 );
+    };
+
+    while ( count < JIT_MAX_BLOCK_INSTRUCTIONS && !ended ) {
+        // Code read through a device may change without a write, so it is
+        // left to the interpreter, before decoding reads the device
+        uint16_t end = address + MAX_INSTRUCTION_LENGTH - 1;
+        if (
+            memory->IsReadMapped( address >> 8 ) ||
+            memory->IsReadMapped( end >> 8 )
+        )
+            break;
+
+        DecodedInstruction ins = cpu->decodeCache.Lookup( address );
+        uint8_t family = ins.opcode >> 4;
+        uint8_t low = ins.opcode & 0xF;
+
+        bool registerFamily =
+            ( family >= 0x8 && family <= 0xB ) && low <= 0xE;
+        bool stackFamily = ins.opcode >= INS_PUSHA && ins.opcode <= INS_LEAVE;
+        if ( !registerFamily && !stackFamily && ins.opcode != INS_JMP )
+            break;
+
+        uint16_t next = address + ins.length;
+        cycles += ins.cycles;
+        count++;
+        ipDelta += ins.length;
+
+        if ( registerFamily ) {
+            int32_t reg = familyRegisters[family - 0x8];
+
+            // Segment, base, index, offset immediate and pointer of the
+            // stack and data addressing modes
+            bool stack = low == 1 || low == 2 || low == 5 || low == 6;
+            bool pointer = low == 2 || low == 4 || low == 6 || low == 8;
+            int32_t segment = stack ? offsetSS : offsetDS;
+            int32_t base = stack ? offsetBP : -1;
+
+            // A and Y index with X, B and X with an immediate offset
+            int32_t index = -1;
+            uint32_t offsetImmediate = 0;
+            if ( reg == offsetA || reg == offsetY )
+                index = offsetX;
+            else
+                offsetImmediate = ins.imm8;
+
+            // A and X point with Y, B and Y with an immediate pointer
+            int32_t pointerRegister = -1;
+            uint16_t pointerImmediate = 0;
+            if ( reg == offsetA || reg == offsetX )
+                pointerRegister = offsetY;
+            else
+                pointerImmediate = ins.imm16;
+
+            if ( low == 0 ) {
+                // Load immediate
+                emit.StoreFieldImmediate( reg, ins.imm16 );
+                emit.AndFieldByte( offsetFlags, 0xF5 );
+                uint8_t flags =
+                    ( ins.imm16 == 0 ) << 1 | ( ins.imm16 >> 15 ) << 3;
+                if ( flags != 0 )
+                    emit.OrFieldByte( offsetFlags, flags );
+            }
+            else if ( low <= 4 ) {
+                // Load from memory
+                emitAddress( segment, base, index, offsetImmediate );
+                emit.CallHelper( read );
+                if ( pointer ) {
+                    emitPointerAddress( pointerRegister, pointerImmediate );
+                    emit.CallHelper( read );
+                }
+                emit.StoreField( reg, RAX );
+                emitFlags();
+            }
+            else if ( low <= 8 ) {
+                // Store to memory
+                emitAddress( segment, base, index, offsetImmediate );
+                if ( pointer ) {
+                    emit.CallHelper( read );
+                    emitPointerAddress( pointerRegister, pointerImmediate );
+                }
+                emit.LoadField( RDX, reg );
+                emit.CallHelper( (void*)Write16 );
+                emitWriteCheck();
+            }
+            else {
+                // Transfer, to the other three registers then SS, CS, DS
+                const int32_t targets[] = {
+                    offsetA, offsetB, offsetX, offsetY,
+                    offsetSS, offsetCS, offsetDS,
+                };
+                int target = low - 9;
+                int skipped = 0;
+                for ( int i = 0; i < 4; i++ ) {
+                    if ( targets[i] == reg )
+                        skipped = i;
+                }
+                int32_t destination =
+                    target < 3
+                        ? targets[target + ( target >= skipped )]
+                        : targets[target + 1];
+
+                emit.LoadField( RAX, reg );
+                emit.StoreField( destination, RAX );
+
+                // A new code segment moves every following instruction
+                if ( destination == offsetCS ) {
+                    emitExit();
+                    ended = true;
+                }
+            }
+        }
+        else if ( stackFamily ) {
+            const int32_t stackRegisters[] = {
+                offsetA, offsetB, offsetX, offsetY,
+            };
+
+            switch ( ins.opcode ) {
+                case INS_PUSHA:
+                case INS_PUSHB:
+                case INS_PUSHX:
+                case INS_PUSHY:
+                    emit.AddFieldImmediate( offsetSP, (uint16_t)-2 );
+                    emitStackAddress();
+                    emit.LoadField(
+                        RDX, stackRegisters[( ins.opcode - INS_PUSHA ) / 2]
+                    );
+                    emit.CallHelper( (void*)Write16 );
+                    emitWriteCheck();
+                    break;
+
+                case INS_POPA:
+                case INS_POPB:
+                case INS_POPX:
+                case INS_POPY:
+                    emitStackAddress();
+                    emit.CallHelper( read );
+                    emit.StoreField(
+                        stackRegisters[( ins.opcode - INS_POPA ) / 2], RAX
+                    );
+                    emit.AddFieldImmediate( offsetSP, 2 );
+                    break;
+
+                case INS_ENTER:
+                    emit.AddFieldImmediate( offsetSP, (uint16_t)-2 );
+                    emitStackAddress();
+                    emit.LoadField( RDX, offsetBP );
+                    emit.CallHelper( (void*)Write16 );
+                    emit.LoadField( RDX, offsetSP );
+                    emit.StoreField( offsetBP, RDX );
+                    emitWriteCheck();
+                    break;
+
+                case INS_LEAVE:
+                    emit.LoadField( RAX, offsetBP );
+                    emit.StoreField( offsetSP, RAX );
+                    emitStackAddress();
+                    emit.CallHelper( read );
+                    emit.StoreField( offsetBP, RAX );
+                    emit.AddFieldImmediate( offsetSP, 2 );
+                    break;
+            }
+        }
+        else {
+            // Short jump
+            ipDelta += (int8_t)ins.imm8;
+            emitChain( next + (int8_t)ins.imm8 );
+            ended = true;
+        }
+
+        address = next;
+    }
+
+    if ( count == 0 )
+        return nullptr;
+    if ( !ended )
+        emitChain( address );
+
+    // Remember which pages hold the block's code
+    uint8_t firstPage = start >> 8;
+    uint8_t lastPage = (uint16_t)( address - 1 ) >> 8;
+    pageBlocks[firstPage].push_back( start );
+    memory->WatchPage( firstPage, watcherSlot );
+    if ( lastPage != firstPage ) {
+        pageBlocks[lastPage].push_back( start );
+        memory->WatchPage( lastPage, watcherSlot );
+    }
+
+    bufferUsed += emit.Position() - code;
+    blocks[start] = code;
+    return code;
+}
+
+}
+
+#endif
@@ -0,0 +1,121 @@
+/*
+* Copyright © 2025 Micro-16 Team
+* 
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the “Software”), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+* 
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+* 
+* THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#ifndef JIT_HPP
+#define JIT_HPP
+
+// Define BTP_JIT (-DBTP_JIT) to build the x86-64 dynamic recompiler
+#ifdef BTP_JIT
+
+#if !defined( __x86_64__ ) || defined( _WIN32 )
+#error "BTP_JIT needs an x86-64 host with the System V ABI and mmap"
+#endif
+
+#include <vector>
+
+#include "stdint.h"
+
+#include "Btp.hpp"
+
+namespace btp {
+
+#define JIT_BUFFER_SIZE            0x400000 // Executable memory in bytes
+#define JIT_MAX_BLOCK_INSTRUCTIONS 32
+#define JIT_MAX_BLOCK_CODE         0x1000   // Worst case native block size
+
+// Dynamic recompiler
+// Translates basic blocks of BTP6000 code into native x86-64 code. Blocks are
+// keyed by the linear address they start at and chain straight into each
+// other through a block table. Writing to a page of memory drops every block
+// with code in it. Anything the recompiler does not know how to translate is
+// run one instruction at a time by BetterThanPico::Execute().
+class Jit : public Bob3kWatcher {
+public:
+    // Attaches the recompiler to a CPU, whose memory must already be set.
+    // Without a free watcher slot on that memory it only ever interprets.
+    Jit( BetterThanPico *cpu );
+
+    // Frees the executable memory and block table
+    ~Jit();
+
+    // Owns executable memory
+    Jit( const Jit & ) = delete;
+    Jit &operator=( const Jit & ) = delete;
+
+    // Same as BetterThanPico::RunCycles(), but a whole block runs before the
+    // budget is checked. Breakpoints are only honored by the interpreter, so
+    // this falls back to it while any are set.
+    RunResult RunCycles( uint32_t budget );
+
+    // Same as BetterThanPico::RunFrame(), running the slices between events
+    // with RunCycles()
+    RunResult RunFrame();
+
+    // Drops every translated block
+    void Flush();
+
+    // Drops the blocks in a page when it is written to
+    void PageWritten( uint8_t page ) override;
+
+private:
+    // Native entry point: runs blocks from `code` and returns the cycles in
+    // the low half and the instructions in the high half
+    using Entry = uint64_t (*)(
+        BetterThanPico *cpu, Jit *jit, void *code, uint32_t budget
+    );
+
+    BetterThanPico *cpu;
+    Bob3k *memory;
+    int watcherSlot;
+
+    uint8_t *buffer;        // Executable memory
+    size_t bufferUsed = 0;
+    Entry entry;            // Prologue, jumps into a block
+    uint8_t *exitStub;      // Epilogue, returns to RunCycles()
+
+    void **blocks;          // Native code by linear address
+    std::vector<uint16_t> pageBlocks[BOB3K_PAGE_COUNT]; // Blocks in a page
+    uint32_t invalidations = 0;
+    bool readDevices = false; // Blocks were translated to read through them
+
+    // Byte offsets of the CPU registers
+    int32_t offsetA, offsetB, offsetX, offsetY, offsetIP, offsetSP,
+        offsetBP, offsetSS, offsetCS, offsetDS, offsetFlags;
+
+    // Emits the entry and exit stubs at the start of the buffer
+    void EmitStubs();
+
+    // Translates the block starting at a linear address, returns nullptr if
+    // its first instruction cannot be translated
+    void *Translate( uint16_t address );
+
+    // Memory helpers called from native code, ReadRam16() while no device is
+    // mapped for reading
+    static uint32_t Read16( Jit *jit, uint32_t address );
+    static uint32_t ReadRam16( Jit *jit, uint32_t address );
+    static uint32_t Write16( Jit *jit, uint32_t address, uint32_t value );
+};
+
+}
+
+#endif
+#endif
@@ -0,0 +1,764 @@
+/*
+* Copyright © 2025 Micro-16 Team
+* 
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the “Software”), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+* 
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+* 
+* THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+#include "Lockstep.hpp"
+
+#include <algorithm>
+#include <bitset>
+#include <initializer_list>
+
+#include "string.h"
+
+// The vector core needs an x86-64 GCC or Clang; it is checked for AVX2 at run
+// time, so the rest of the program does not need to be built with -mavx2
+#if defined( __x86_64__ ) && ( defined( __GNUC__ ) || defined( __clang__ ) )
+#define LOCKSTEP_AVX2
+#include <immintrin.h>
+#endif
+
+namespace btp {
+
+// Creates `count` lanes with zeroed memory and reset CPUs
+Lockstep::Lockstep( uint32_t count )
+    : count( count ), memories( new Bob3k[count] ),
+      cpus( new BetterThanPico[count] ), results( count ) {
+    for ( uint32_t i = 0; i < count; i++ ) {
+        memset( memories[i].data(), 0, BOB3K_SIZE );
+        cpus[i].Reset();
+        cpus[i].SetMemory( &memories[i] );
+    }
+}
+
+// Runs one frame on every lane
+void Lockstep::RunFrame() {
+    for ( uint32_t first = 0; first < count; first += LOCKSTEP_LANES )
+        RunGroup( first, std::min<uint32_t>( LOCKSTEP_LANES, count - first ) );
+}
+
+// Runs the rest of a lane's frame on the scalar core, after it ran `result`
+// in lockstep
+void Lockstep::FinishScalar( uint32_t lane, RunResult result ) {
+    BetterThanPico &cpu = cpus[lane];
+    uint32_t budget = CYCLES_PER_FRAME - cpu.cycleDebt;
+
+    RunResult rest = cpu.RunEvents(
+        result.cycles < budget ? budget - result.cycles : 0,
+        [&cpu]( uint32_t cycles ) { return cpu.RunCycles( cycles ); }
+    );
+    scalarInstructions += rest.instructions;
+
+    result.cycles += rest.cycles;
+    result.instructions += rest.instructions;
+    result.reason = rest.reason;
+    if ( result.reason == STOP_BUDGET )
+        cpu.cycleDebt = result.cycles - budget;
+    else
+        cpu.cycleDebt = 0;
+
+    results[lane] = result;
+}
+
+#ifdef LOCKSTEP_AVX2
+
+#if defined( __clang__ )
+#pragma clang attribute push ( \
+    __attribute__(( target( "avx2" ) )), apply_to = function )
+#else
+#pragma GCC push_options
+#pragma GCC target( "avx2" )
+#endif
+
+// A group of lanes at the same instruction
+// The registers are named like BetterThanPico's and the memory helpers take
+// the same arguments, so the group runs the same Handlers.hpp as the scalar
+// cores, only on a register of every lane at once.
+class Lockstep::Group {
+public:
+    // Sets up the lanes in `members`, relative to `first`, which are all at
+    // the leader's CS:IP with the same cycle debt and no interrupt ready to
+    // be taken, and have all run `progress` of the frame
+    Group(
+        Lockstep &owner,
+        uint32_t first,
+        uint32_t lanes,
+        uint32_t members,
+        uint32_t leader,
+        RunResult progress
+    );
+
+    // Runs the frame up to the next event: the first lane's timer running
+    // out, WAI or a write to the interrupt page. Lanes that stay until then
+    // are up to date afterwards, the rest are finished with FinishScalar().
+    void Run();
+
+    // Lanes that stopped at an event before the end of the frame
+    uint32_t Paused() const {
+        return live;
+    }
+
+    // What every lane in the group has run of the frame
+    RunResult Progress() const {
+        return result;
+    }
+
+private:
+    // A 16-bit register of every lane
+    struct Word {
+        __m256i v;
+
+        Word &operator+=( int n ) {
+            v = _mm256_add_epi16( v, _mm256_set1_epi16( n ) );
+            return *this;
+        }
+    };
+
+    // Like btp::Register, for the handlers' A.value and B.value
+    struct LaneRegister {
+        Word value;
+    };
+
+    Lockstep &owner;
+    uint32_t first;
+    uint32_t live;   // Bit per lane still in the group
+    uint32_t leader; // Lane whose code and CS:IP the group follows
+    uint16_t pc;     // Linear address of the next instruction
+    uint32_t debt;   // Cycle debt of every lane
+    uint32_t limit;  // Frame cycles at the first lane's timer event
+    uint32_t waiting = 0; // Bit per lane stopped by WAI
+    bool stopped = false; // An event needs the scalar frame loop
+
+    // Lane i's memory starts at base + offsets[i]
+    const uint8_t *base;
+    __m256i offsetsLow, offsetsHigh; // 32-bit offsets of lanes 0-7 and 8-15
+
+    // Pages whose bytes are the same in every lane
+    std::bitset<BOB3K_PAGE_COUNT> verified;
+
+    // Registers
+    LaneRegister A, B;
+    Word X, Y;
+    Word IP, SP, BP;
+    Word SS, CS, DS;
+
+    // Loads only record their value, and Z and N are worked out from it a
+    // lane at a time when something reads the flags, rather than on every load
+    uint8_t flags[LOCKSTEP_LANES];
+    bool flagsLoaded = false; // flagResult holds a load newer than flags
+    Word flagResult;
+
+    RunResult start;  // Of every lane when the group formed
+    RunResult result; // Of every lane in the group
+
+    // Returns one lane of a register
+    static uint16_t Lane( const Word &word, uint32_t lane ) {
+        alignas( 32 ) uint16_t values[LOCKSTEP_LANES];
+        _mm256_store_si256( (__m256i*)values, word.v );
+        return values[lane];
+    }
+
+    // A register with the same value in every lane
+    static Word Broadcast( uint16_t value ) {
+        return { _mm256_set1_epi16( value ) };
+    }
+
+    static Word Add( const Word &a, const Word &b ) {
+        return { _mm256_add_epi16( a.v, b.v ) };
+    }
+
+    // Returns the resolved flags of a lane
+    Flags LaneFlags( uint32_t lane );
+
+    // Returns the state of a lane
+    CpuState GetState( uint32_t lane );
+
+    // Takes a lane out of the group before the next instruction
+    void Leave( uint32_t lane );
+
+    // Makes sure every lane has the same bytes as the leader for an
+    // instruction, taking out those that do not
+    void CheckCode( const DecodedInstruction &ins );
+
+    // Takes out the lanes that no longer are at the leader's CS:IP
+    void CheckControl();
+
+    // Returns true if every live lane has a vector installed
+    bool IsVectorInstalled( uint8_t vector ) {
+        for ( uint32_t lanes = live; lanes; lanes &= lanes - 1 ) {
+            uint32_t lane = __builtin_ctz( lanes );
+            if ( !owner.cpus[first + lane].IsVectorInstalled( vector ) )
+                return false;
+        }
+        return true;
+    }
+
+    // Calculates an address from a segment and an offset in every lane
+    Word CalculateAddress( const Word &segment, const Word &offset ) {
+        return Add( { _mm256_slli_epi16( segment.v, 4 ) }, offset );
+    }
+
+    // Reads a word at a linear address in every lane
+    Word Read16( const Word &address );
+
+    // Writes a word at a linear address in every live lane
+    void Write16( const Word &address, const Word &value );
+
+    // Records a load for the flags of every lane
+    void GenericFlagSet( const Word &value ) {
+        flagResult = value;
+        flagsLoaded = true;
+    }
+
+    template <int reg>
+    Word &AccessedRegister() {
+        if constexpr ( reg == REG_A ) return A.value;
+        if constexpr ( reg == REG_B ) return B.value;
+        if constexpr ( reg == REG_X ) return X;
+        if constexpr ( reg == REG_Y ) return Y;
+    }
+
+    template <int source>
+    Word Operand( const DecodedInstruction &ins ) {
+        if constexpr ( source == SOURCE_X ) return X;
+        if constexpr ( source == SOURCE_Y ) return Y;
+        if constexpr ( source == SOURCE_IMM8 ) return Broadcast( ins.imm8 );
+        if constexpr ( source == SOURCE_IMM16 ) return Broadcast( ins.imm16 );
+    }
+
+    template <int reg, int mode>
+    Word EffectiveAddress( const DecodedInstruction &ins ) {
+        constexpr RegisterLayout layout = registerLayouts[reg];
+
+        Word offset = Operand<layout.offset>( ins );
+        if constexpr ( IsStackMode( mode ) )
+            offset = Add( offset, BP );
+        Word address =
+            CalculateAddress( IsStackMode( mode ) ? SS : DS, offset );
+
+        if constexpr ( IsPointerMode( mode ) ) {
+            Word pointer = Read16( address );
+            address = CalculateAddress(
+                SS, Add( pointer, Operand<layout.pointer>( ins ) )
+            );
+        }
+        return address;
+    }
+
+    template <int reg, int mode>
+    void Load( const DecodedInstruction &ins ) {
+        Word value;
+        if constexpr ( mode == MODE_IM )
+            value = Broadcast( ins.imm16 );
+        else
+            value = Read16( EffectiveAddress<reg, mode>( ins ) );
+
+        AccessedRegister<reg>() = value;
+        GenericFlagSet( value );
+    }
+
+    template <int reg, int mode>
+    void Store( const DecodedInstruction &ins ) {
+        Write16( EffectiveAddress<reg, mode>( ins ), AccessedRegister<reg>() );
+    }
+
+    void Push16( const Word &value ) {
+        SP += -2;
+        Write16( CalculateAddress( SS, SP ), value );
+    }
+
+    Word Pop16() {
+        Word value = Read16( CalculateAddress( SS, SP ) );
+        SP += 2;
+        return value;
+    }
+
+    // Idle loops are left to the scalar core
+    void Jump( const DecodedInstruction &ins ) {
+        IP += (int8_t)ins.imm8;
+    }
+
+    // Lanes without the vector installed have already left the group
+    void SoftwareInterrupt( const DecodedInstruction &ins ) {
+        EnterInterrupt( ins.imm8 );
+    }
+
+    void EnterInterrupt( uint8_t vector );
+
+    void ReturnFromInterrupt();
+
+    void Wait();
+};
+
+// Sets up the lanes in `members`
+Lockstep::Group::Group(
+    Lockstep &owner,
+    uint32_t first,
+    uint32_t lanes,
+    uint32_t members,
+    uint32_t leader,
+    RunResult progress
+) : owner( owner ), first( first ), live( members ), leader( leader ),
+    start( progress ), result( progress ) {
+    base = owner.memories[first].data();
+    alignas( 32 ) int32_t offsets[LOCKSTEP_LANES] = {};
+    for ( uint32_t i = 0; i < lanes; i++ )
+        offsets[i] = owner.memories[first + i].data() - base;
+    offsetsLow = _mm256_load_si256( (const __m256i*)offsets );
+    offsetsHigh = _mm256_load_si256( (const __m256i*)( offsets + 8 ) );
+
+    alignas( 32 ) uint16_t registers[10][LOCKSTEP_LANES] = {};
+    for ( uint32_t i = 0; i < lanes; i++ ) {
+        if ( !( members & ( 1 << i ) ) )
+            continue;
+
+        CpuState state = owner.cpus[first + i].GetState();
+        registers[0][i] = state.A;
+        registers[1][i] = state.B;
+        registers[2][i] = state.X;
+        registers[3][i] = state.Y;
+        registers[4][i] = state.IP;
+        registers[5][i] = state.SP;
+        registers[6][i] = state.BP;
+        registers[7][i] = state.SS;
+        registers[8][i] = state.CS;
+        registers[9][i] = state.DS;
+        flags[i] = state.flags;
+    }
+
+    Word *words[10] = {
+        &A.value, &B.value, &X, &Y, &IP, &SP, &BP, &SS, &CS, &DS,
+    };
+    for ( int r = 0; r < 10; r++ )
+        words[r]->v = _mm256_load_si256( (const __m256i*)registers[r] );
+    flagResult = Broadcast( 0 );
+
+    BetterThanPico &cpu = owner.cpus[first + leader];
+    pc = cpu.CalculateAddress( cpu.CS, cpu.IP );
+    debt = cpu.cycleDebt;
+
+    // Lanes may be counting towards different timer events
+    uint32_t cycles = CYCLES_PER_FRAME - debt - result.cycles;
+    for ( uint32_t lanes = live; lanes; lanes &= lanes - 1 ) {
+        uint32_t lane = first + __builtin_ctz( lanes );
+        cycles = std::min( cycles, owner.cpus[lane].UntilTimer() );
+    }
+    limit = result.cycles + cycles;
+}
+
+// Returns the resolved flags of a lane
+Flags Lockstep::Group::LaneFlags( uint32_t lane ) {
+    Flags laneFlags = { flags[lane] };
+    if ( flagsLoaded ) {
+        uint16_t value = Lane( flagResult, lane );
+        laneFlags.Z = ( value == 0 );
+        laneFlags.N = ( value >> 15 );
+    }
+    return laneFlags;
+}
+
+// Returns the state of a lane
+CpuState Lockstep::Group::GetState( uint32_t lane ) {
+    // The interrupt and timer state does not change in the group
+    CpuState state = owner.cpus[first + lane].GetState();
+
+    state.A = Lane( A.value, lane );
+    state.B = Lane( B.value, lane );
+    state.X = Lane( X, lane );
+    state.Y = Lane( Y, lane );
+    state.IP = Lane( IP, lane );
+    state.SP = Lane( SP, lane );
+    state.BP = Lane( BP, lane );
+    state.SS = Lane( SS, lane );
+    state.CS = Lane( CS, lane );
+    state.DS = Lane( DS, lane );
+    state.flags = LaneFlags( lane ).value;
+    state.halted = result.reason == STOP_HALT;
+    state.waiting = ( waiting >> lane ) & 1;
+    state.cycleDebt = debt;
+    return state;
+}
+
+// Works like BetterThanPico's, on every lane
+void Lockstep::Group::EnterInterrupt( uint8_t vector ) {
+    alignas( 32 ) uint16_t pushed[LOCKSTEP_LANES];
+    for ( uint32_t lane = 0; lane < LOCKSTEP_LANES; lane++ ) {
+        Flags laneFlags = LaneFlags( lane );
+        pushed[lane] = laneFlags.value;
+        laneFlags.I = 1;
+        flags[lane] = laneFlags.value;
+    }
+    flagsLoaded = false;
+
+    Push16( { _mm256_load_si256( (const __m256i*)pushed ) } );
+    Push16( CS );
+    Push16( IP );
+
+    Word entry = Broadcast( InterruptEntry( vector ) );
+    CS = Read16( entry );
+    entry += 2;
+    IP = Read16( entry );
+}
+
+// Works like BetterThanPico's, on every lane. Stops the group if that
+// unmasked a pending interrupt in any lane.
+void Lockstep::Group::ReturnFromInterrupt() {
+    IP = Pop16();
+    CS = Pop16();
+
+    alignas( 32 ) uint16_t popped[LOCKSTEP_LANES];
+    _mm256_store_si256( (__m256i*)popped, Pop16().v );
+    for ( uint32_t lane = 0; lane < LOCKSTEP_LANES; lane++ )
+        flags[lane] = (uint8_t)popped[lane];
+    flagsLoaded = false;
+
+    for ( uint32_t lanes = live; lanes; lanes &= lanes - 1 ) {
+        uint32_t lane = __builtin_ctz( lanes );
+        Flags laneFlags = { flags[lane] };
+        if ( owner.cpus[first + lane].pendingInterrupts && !laneFlags.I )
+            stopped = true;
+    }
+}
+
+// Works like BetterThanPico's, on every lane. Lanes with a masked interrupt
+// pending carry on, but the group stops either way.
+void Lockstep::Group::Wait() {
+    for ( uint32_t lanes = live; lanes; lanes &= lanes - 1 ) {
+        uint32_t lane = __builtin_ctz( lanes );
+        if ( owner.cpus[first + lane].pendingInterrupts == 0 )
+            waiting |= 1 << lane;
+    }
+    stopped = true;
+}
+
+// Takes a lane out of the group before the next instruction
+void Lockstep::Group::Leave( uint32_t lane ) {
+    BetterThanPico &cpu = owner.cpus[first + lane];
+    cpu.SetState( GetState( lane ) );
+    cpu.AdvanceTimer( result.cycles - start.cycles );
+    owner.lockstepInstructions += result.instructions - start.instructions;
+    owner.FinishScalar( first + lane, result );
+    live &= ~( 1 << lane );
+}
+
+// Makes sure every lane has the same bytes as the leader for an instruction
+void Lockstep::Group::CheckCode( const DecodedInstruction &ins ) {
+    uint8_t firstPage = pc >> 8;
+    uint8_t lastPage = (uint16_t)( pc + ins.length - 1 ) >> 8;
+    if ( verified[firstPage] && verified[lastPage] )
+        return;
+
+    // Whole pages first, so that most code is only compared once a frame
+    const uint8_t *leaderMemory = owner.memories[first + leader].data();
+    bool same = true;
+    for ( uint8_t page : { firstPage, lastPage } ) {
+        if ( verified[page] )
+            continue;
+
+        bool samePage = true;
+        for ( uint32_t lanes = live; lanes; lanes &= lanes - 1 ) {
+            uint32_t lane = __builtin_ctz( lanes );
+            if ( memcmp(
+                owner.memories[first + lane].data() + page * BOB3K_PAGE_SIZE,
+                leaderMemory + page * BOB3K_PAGE_SIZE,
+                BOB3K_PAGE_SIZE
+            ) ) {
+                samePage = false;
+                break;
+            }
+        }
+        if ( samePage )
+            verified.set( page );
+        same &= samePage;
+    }
+    if ( same )
+        return;
+
+    // Then the instruction itself
+    for ( uint32_t lanes = live; lanes; lanes &= lanes - 1 ) {
+        uint32_t lane = __builtin_ctz( lanes );
+        const Bob3k &memory = owner.memories[first + lane];
+        for ( int i = 0; i < ins.length; i++ ) {
+            uint16_t address = pc + i;
+            if ( memory.Read( address ) != leaderMemory[address] ) {
+                Leave( lane );
+                break;
+            }
+        }
+    }
+}
+
+// Takes out the lanes that no longer are at the leader's CS:IP
+void Lockstep::Group::CheckControl() {
+    Word linear = CalculateAddress( CS, IP );
+    pc = Lane( linear, leader );
+
+    __m256i same = _mm256_cmpeq_epi16( linear.v, Broadcast( pc ).v );
+    uint32_t bytes = _mm256_movemask_epi8( same );
+    for ( uint32_t lanes = live; lanes; lanes &= lanes - 1 ) {
+        uint32_t lane = __builtin_ctz( lanes );
+        if ( !( bytes & ( 1 << ( lane * 2 ) ) ) )
+            Leave( lane );
+    }
+}
+
+// Reads a word at a linear address in every lane
+Lockstep::Group::Word Lockstep::Group::Read16( const Word &address ) {
+    __m256i low = _mm256_add_epi32(
+        _mm256_cvtepu16_epi32( _mm256_castsi256_si128( address.v ) ),
+        offsetsLow
+    );
+    __m256i high = _mm256_add_epi32(
+        _mm256_cvtepu16_epi32( _mm256_extracti128_si256( address.v, 1 ) ),
+        offsetsHigh
+    );
+
+    // Four bytes are gathered per lane, the top two are dropped. Reading
+    // past a lane's last byte stays inside its Bob3k.
+    __m256i mask = _mm256_set1_epi32( 0xFFFF );
+    low = _mm256_and_si256(
+        _mm256_i32gather_epi32( (const int*)base, low, 1 ), mask
+    );
+    high = _mm256_and_si256(
+        _mm256_i32gather_epi32( (const int*)base, high, 1 ), mask
+    );
+
+    // packus interleaves the 128-bit halves, the permute puts lanes in order
+    Word value = { _mm256_permute4x64_epi64(
+        _mm256_packus_epi32( low, high ), 0xD8
+    ) };
+
+    // A word at the last byte wraps around to the first
+    __m256i wraps = _mm256_cmpeq_epi16( address.v, _mm256_set1_epi16( -1 ) );
+    if ( !_mm256_testz_si256( wraps, wraps ) ) {
+        alignas( 32 ) uint16_t values[LOCKSTEP_LANES];
+        alignas( 32 ) uint16_t addresses[LOCKSTEP_LANES];
+        _mm256_store_si256( (__m256i*)values, value.v );
+        _mm256_store_si256( (__m256i*)addresses, address.v );
+        for ( uint32_t lanes = live; lanes; lanes &= lanes - 1 ) {
+            uint32_t lane = __builtin_ctz( lanes );
+            values[lane] =
+                owner.memories[first + lane].Read16( addresses[lane] );
+        }
+        value.v = _mm256_load_si256( (const __m256i*)values );
+    }
+
+    return value;
+}
+
+// Writes a word at a linear address in every live lane
+void Lockstep::Group::Write16( const Word &address, const Word &value ) {
+    alignas( 32 ) uint16_t values[LOCKSTEP_LANES], addresses[LOCKSTEP_LANES];
+    _mm256_store_si256( (__m256i*)values, value.v );
+    _mm256_store_si256( (__m256i*)addresses, address.v );
+
+    // AVX2 has no scatter, and writes have to reach the watchers anyway
+    for ( uint32_t lanes = live; lanes; lanes &= lanes - 1 ) {
+        uint32_t lane = __builtin_ctz( lanes );
+        uint16_t at = addresses[lane];
+        owner.memories[first + lane].Write16( at, values[lane] );
+        verified.reset( at >> 8 );
+        verified.reset( (uint16_t)( at + 1 ) >> 8 );
+
+        // The interrupt table or timer period changed
+        if (
+            at >> 8 == INTERRUPT_PAGE ||
+            (uint16_t)( at + 1 ) >> 8 == INTERRUPT_PAGE
+        )
+            stopped = true;
+    }
+}
+
+// Runs a frame
+void Lockstep::Group::Run() {
+    uint32_t budget = CYCLES_PER_FRAME - debt;
+    DecodedInstruction ins;
+
+    // A single lane is better off on the scalar core
+    while (
+        result.cycles < limit && !stopped && ( live & ( live - 1 ) )
+    ) {
+        // Copied, since a store may invalidate the cached entry
+        ins = owner.cpus[first + leader].decodeCache.Lookup( pc );
+        CheckCode( ins );
+
+        // An INT through a vector that some lane has not installed halts
+        // that lane, so the whole group finishes on the scalar core
+        if ( ins.opcode == INS_INT && !IsVectorInstalled( ins.imm8 ) ) {
+            for ( uint32_t lanes = live; lanes; lanes &= lanes - 1 )
+                Leave( __builtin_ctz( lanes ) );
+            return;
+        }
+
+        IP += ins.length;
+        pc += ins.length;
+        result.cycles += ins.cycles;
+        result.instructions++;
+
+        switch ( ins.opcode ) {
+            #define HANDLER( name, opcode, ... ) \
+                case opcode: __VA_ARGS__; break;
+            #include "Handlers.hpp"
+            #undef HANDLER
+
+            // Undefined
+            default:
+                IP += -1;
+                result.reason = STOP_HALT;
+                break;
+        }
+
+        if ( result.reason == STOP_HALT )
+            break;
+        if ( ins.opcode == INS_JMP )
+            pc += (int8_t)ins.imm8;
+        else if (
+            ins.opcode == INS_TACS || ins.opcode == INS_TBCS ||
+            ins.opcode == INS_TXCS || ins.opcode == INS_TYCS ||
+            ins.opcode == INS_INT || ins.opcode == INS_RTI
+        )
+            CheckControl();
+    }
+
+    // A single lane left before the end finishes on the scalar core
+    bool ended = result.reason == STOP_HALT || result.cycles >= budget;
+    if ( !ended && !( live & ( live - 1 ) ) ) {
+        for ( uint32_t lanes = live; lanes; lanes &= lanes - 1 )
+            Leave( __builtin_ctz( lanes ) );
+        return;
+    }
+
+    // The rest either end the frame or pause at the event
+    uint32_t newDebt =
+        result.reason == STOP_BUDGET ? result.cycles - budget : 0;
+    for ( uint32_t lanes = live; lanes; lanes &= lanes - 1 ) {
+        uint32_t lane = __builtin_ctz( lanes );
+        CpuState state = GetState( lane );
+        if ( ended )
+            state.cycleDebt = newDebt;
+        owner.cpus[first + lane].SetState( state );
+        owner.cpus[first + lane].AdvanceTimer( result.cycles - start.cycles );
+        if ( ended )
+            owner.results[first + lane] = result;
+        owner.lockstepInstructions += result.instructions - start.instructions;
+    }
+    if ( ended )
+        live = 0;
+}
+
+#if defined( __clang__ )
+#pragma clang attribute pop
+#else
+#pragma GCC pop_options
+#endif
+
+// Returns true if this host runs groups with AVX2
+bool Lockstep::IsVectorized() {
+    static const bool avx2 = __builtin_cpu_supports( "avx2" );
+    return avx2;
+}
+
+#else
+
+// Returns true if this host runs groups with AVX2
+bool Lockstep::IsVectorized() {
+    return false;
+}
+
+#endif
+
+// Runs a frame on the lanes [first, first + lanes)
+void Lockstep::RunGroup( uint32_t first, uint32_t lanes ) {
+    uint32_t started = 0; // Lanes whose frame was started here
+
+    #ifdef LOCKSTEP_AVX2
+    if ( IsVectorized() ) {
+        // Start the frame like RunFrame(), so that lanes taking the same
+        // vblank interrupt can run its handler together
+        for ( uint32_t i = 0; i < lanes; i++ ) {
+            BetterThanPico &cpu = cpus[first + i];
+            if (
+                cpu.halted || cpu.observed || cpu.HasBreakpoints() ||
+                memories[first + i].HasDevices()
+            )
+                continue;
+
+            cpu.RaiseInterrupt( IRQ_VBLANK );
+            cpu.ServiceInterrupts();
+            started |= 1 << i;
+        }
+
+        // Lanes that have run `progress` of the frame and are between
+        // events, regrouped after every event
+        uint32_t ready = started;
+        RunResult progress = { 0, 0, STOP_BUDGET };
+        while ( true ) {
+            // Lanes at the first ready lane's CS:IP and cycle debt
+            uint32_t members = 0;
+            int leader = -1;
+            uint16_t pc = 0;
+            for ( uint32_t bits = ready; bits; bits &= bits - 1 ) {
+                uint32_t i = __builtin_ctz( bits );
+                BetterThanPico &cpu = cpus[first + i];
+                if ( cpu.waiting || ( cpu.pendingInterrupts && !cpu.flags.I ) )
+                    continue;
+
+                uint16_t address = cpu.CalculateAddress( cpu.CS, cpu.IP );
+                if ( leader == -1 ) {
+                    leader = i;
+                    pc = address;
+                }
+                else if (
+                    address != pc ||
+                    cpu.cycleDebt != cpus[first + leader].cycleDebt
+                )
+                    continue;
+                members |= 1 << i;
+            }
+            if ( !( members & ( members - 1 ) ) )
+                break;
+
+            Group group( *this, first, lanes, members, leader, progress );
+            group.Run();
+            for ( uint32_t bits = ready & ~members; bits; bits &= bits - 1 )
+                FinishScalar( first + __builtin_ctz( bits ), progress );
+
+            // Take the interrupts the event raised, like RunFrame() would
+            ready = group.Paused();
+            progress = group.Progress();
+            for ( uint32_t bits = ready; bits; bits &= bits - 1 )
+                cpus[first + __builtin_ctz( bits )].ServiceInterrupts();
+        }
+
+        for ( uint32_t bits = ready; bits; bits &= bits - 1 )
+            FinishScalar( first + __builtin_ctz( bits ), progress );
+    }
+    #endif
+
+    for ( uint32_t i = 0; i < lanes; i++ ) {
+        if ( started & ( 1 << i ) )
+            continue;
+        results[first + i] = cpus[first + i].RunFrame();
+        scalarInstructions += results[first + i].instructions;
+    }
+}
+
+}
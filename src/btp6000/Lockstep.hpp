@@ -0,0 +1,112 @@
+/*
+* Copyright © 2025 Micro-16 Team
+* 
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the “Software”), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+* 
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+* 
+* THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+#ifndef LOCKSTEP_HPP
+#define LOCKSTEP_HPP
+
+#include <memory>
+#include <vector>
+
+#include "stdint.h"
+
+#include "Btp.hpp"
+
+// Lanes in a group, one 16-bit register of each in a 256-bit AVX2 vector
+#define LOCKSTEP_LANES 16
+
+namespace btp {
+
+// Lockstep interpreter
+// Runs many copies of one program, each with its own CPU and memory. Every
+// frame, lanes that are at the same instruction run together in groups of up
+// to LOCKSTEP_LANES: each instruction is fetched and decoded once and executed
+// on the whole group with AVX2, the registers being kept as one vector per
+// register (struct of arrays). A lane that ends up somewhere else after
+// writing CS, or whose code bytes differ from the group's, leaves the group
+// and finishes the frame on the scalar core. So does every lane on hosts
+// without AVX2, every lane that is halted, traced, profiled, has breakpoints
+// or devices mapped into its memory, or waits for an interrupt. Groups stop
+// at every timer event, WAI, RTI that unmasks an interrupt and write to the
+// interrupt page, and the lanes regroup once they have taken their
+// interrupts.
+class Lockstep {
+public:
+    // Creates `count` lanes with zeroed memory and reset CPUs
+    Lockstep( uint32_t count );
+
+    // Number of lanes
+    uint32_t Count() const {
+        return count;
+    }
+
+    // A lane's CPU, to set up or inspect between frames
+    BetterThanPico &Cpu( uint32_t lane ) {
+        return cpus[lane];
+    }
+
+    // A lane's memory
+    Bob3k &Memory( uint32_t lane ) {
+        return memories[lane];
+    }
+
+    // What the last frame ran on every lane
+    const RunResult *Results() const {
+        return results.data();
+    }
+
+    // Runs one frame on every lane, like BetterThanPico::RunFrame()
+    void RunFrame();
+
+    // Lane instructions run in lockstep and on the scalar core so far
+    uint64_t LockstepInstructions() const {
+        return lockstepInstructions;
+    }
+    uint64_t ScalarInstructions() const {
+        return scalarInstructions;
+    }
+
+    // Returns true if this host runs groups with AVX2
+    static bool IsVectorized();
+
+private:
+    class Group;
+
+    uint32_t count;
+    std::unique_ptr<Bob3k[]> memories; // Contiguous, so they can be gathered
+    std::unique_ptr<BetterThanPico[]> cpus;
+    std::vector<RunResult> results;
+
+    uint64_t lockstepInstructions = 0;
+    uint64_t scalarInstructions = 0;
+
+    // Runs a frame on the lanes [first, first + lanes)
+    void RunGroup( uint32_t first, uint32_t lanes );
+
+    // Runs the rest of a lane's frame on the scalar core, after it ran
+    // `result` in lockstep
+    void FinishScalar( uint32_t lane, RunResult result );
+};
+
+}
+
+#endif
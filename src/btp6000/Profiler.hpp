@@ -0,0 +1,265 @@
+/*
+* Copyright © 2025 Micro-16 Team
+* 
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the “Software”), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+* 
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+* 
+* THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+#ifndef PROFILER_HPP
+#define PROFILER_HPP
+
+// Counting profiler. While a Profiler is attached to a BetterThanPico, every
+// interpreted instruction adds to its opcode's count and to the cycles spent
+// at its linear address, and backward jmps are counted as loop iterations.
+// Report() resolves the addresses to the labels given to AddSymbol() (the
+// external labels of a cartridge) and lists where the cycles went.
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "stdio.h"
+#include "stdint.h"
+
+#include "../bob3000/Bob.hpp"
+#include "DecodeCache.hpp"
+
+// The Better Than Pico 6000 namespace
+namespace btp {
+    #include "Instructions.hpp"
+
+    // A named linear address
+    struct Symbol {
+        std::string name;
+        uint16_t address;
+    };
+
+    // Counts instructions and cycles by opcode and by address
+    class Profiler {
+    public:
+        // Allocates the histograms
+        Profiler()
+            : addressCycles( BOB3K_SIZE ), addressCounts( BOB3K_SIZE ),
+              jumpCounts( BOB3K_SIZE ), jumpTargets( BOB3K_SIZE ) {}
+
+        // Counts an instruction about to run at a linear address
+        void Record( uint16_t address, const DecodedInstruction &ins ) {
+            opcodeCounts[ins.opcode]++;
+            addressCycles[address] += ins.cycles;
+            addressCounts[address]++;
+
+            // A backward jmp closes a loop
+            if ( ins.opcode == INS_JMP && (int8_t)ins.imm8 < 0 ) {
+                jumpCounts[address]++;
+                jumpTargets[address] =
+                    address + ins.length + (int8_t)ins.imm8;
+            }
+        }
+
+        // Forgets all counts, but keeps the symbols
+        void Clear();
+
+        // Names the code from an address up to the next symbol
+        void AddSymbol( const std::string &name, uint16_t address ) {
+            symbols.push_back( { name, address } );
+            std::sort(
+                symbols.begin(), symbols.end(),
+                []( const Symbol &a, const Symbol &b ) {
+                    return a.address < b.address;
+                }
+            );
+        }
+
+        // Times an opcode ran
+        uint64_t OpcodeCount( uint8_t opcode ) const {
+            return opcodeCounts[opcode];
+        }
+
+        // Cycles spent on the instruction at a linear address
+        uint64_t AddressCycles( uint16_t address ) const {
+            return addressCycles[address];
+        }
+
+        // Returns "label+offset" for an address, or the bare address if no
+        // symbol lies at or below it
+        std::string Symbolize( uint16_t address ) const;
+
+        // Prints the top `count` functions, loops, opcodes and addresses
+        void Report( FILE *file, int count ) const;
+
+    private:
+        uint64_t opcodeCounts[0x100] = {};
+        std::vector<uint64_t> addressCycles;
+        std::vector<uint64_t> addressCounts;
+        std::vector<uint64_t> jumpCounts;  // Backward jmps taken, by address
+        std::vector<uint16_t> jumpTargets; // Where they went
+        std::vector<Symbol> symbols;       // Sorted by address
+
+        // Index of the symbol an address belongs to, or -1
+        int SymbolIndex( uint16_t address ) const;
+    };
+
+    // Forgets all counts, but keeps the symbols
+    inline void Profiler::Clear() {
+        std::fill( opcodeCounts, opcodeCounts + 0x100, 0 );
+        std::fill( addressCycles.begin(), addressCycles.end(), 0 );
+        std::fill( addressCounts.begin(), addressCounts.end(), 0 );
+        std::fill( jumpCounts.begin(), jumpCounts.end(), 0 );
+    }
+
+    // Index of the symbol an address belongs to, or -1
+    inline int Profiler::SymbolIndex( uint16_t address ) const {
+        int index = -1;
+        for ( size_t i = 0; i < symbols.size(); i++ ) {
+            if ( symbols[i].address <= address )
+                index = i;
+        }
+        return index;
+    }
+
+    // Returns "label+offset" for an address, or the bare address if no symbol
+    // lies at or below it
+    inline std::string Profiler::Symbolize( uint16_t address ) const {
+        char text[16];
+        int index = SymbolIndex( address );
+        if ( index == -1 ) {
+            snprintf( text, sizeof( text ), "%04X", address );
+            return text;
+        }
+
+        uint16_t offset = address - symbols[index].address;
+        if ( offset == 0 )
+            return symbols[index].name;
+        snprintf( text, sizeof( text ), "+0x%X", offset );
+        return symbols[index].name + text;
+    }
+
+    // Prints the top `count` functions, loops, opcodes and addresses
+    inline void Profiler::Report( FILE *file, int count ) const {
+        struct Entry {
+            std::string name;
+            uint64_t cycles;
+            uint64_t count;
+        };
+
+        uint64_t totalCycles = 0, totalInstructions = 0;
+        for ( int i = 0; i < BOB3K_SIZE; i++ ) {
+            totalCycles += addressCycles[i];
+            totalInstructions += addressCounts[i];
+        }
+        double percent = totalCycles != 0 ? 100.0 / totalCycles : 0.0;
+
+        fprintf(
+            file, "Profile: %llu instructions, %llu cycles\n",
+            (unsigned long long)totalInstructions,
+            (unsigned long long)totalCycles
+        );
+
+        // Prints the entries with the most cycles as a table
+        auto printTop = [&](
+            const char *title,
+            const char *countName,
+            const char *nameName,
+            std::vector<Entry> &entries
+        ) {
+            std::sort(
+                entries.begin(), entries.end(),
+                []( const Entry &a, const Entry &b ) {
+                    return a.cycles > b.cycles;
+                }
+            );
+
+            fprintf( file, "\n%s\n", title );
+            fprintf(
+                file, "%14s %7s %14s  %s\n", "cycles", "%", countName, nameName
+            );
+            for ( int i = 0; i < count && i < (int)entries.size(); i++ ) {
+                if ( entries[i].cycles == 0 )
+                    break;
+                fprintf(
+                    file, "%14llu %6.2f%% %14llu  %s\n",
+                    (unsigned long long)entries[i].cycles,
+                    entries[i].cycles * percent,
+                    (unsigned long long)entries[i].count,
+                    entries[i].name.c_str()
+                );
+            }
+        };
+
+        // Functions: everything from a symbol up to the next one
+        std::vector<Entry> functions( symbols.size() + 1 );
+        for ( size_t i = 0; i < symbols.size(); i++ )
+            functions[i].name = symbols[i].name;
+        functions.back().name = "(no label)";
+        for ( int i = 0; i < BOB3K_SIZE; i++ ) {
+            if ( addressCounts[i] == 0 )
+                continue;
+            int index = SymbolIndex( i );
+            Entry &function =
+                index == -1 ? functions.back() : functions[index];
+            function.cycles += addressCycles[i];
+            function.count += addressCounts[i];
+        }
+        printTop(
+            "Top functions by cycles", "instructions", "function", functions
+        );
+
+        // Loops: from the target of a backward jmp up to the jmp itself
+        std::vector<Entry> loops;
+        for ( int i = 0; i < BOB3K_SIZE; i++ ) {
+            if ( jumpCounts[i] == 0 )
+                continue;
+
+            Entry loop = {
+                Symbolize( jumpTargets[i] ) + " .. " + Symbolize( i ),
+                0, jumpCounts[i],
+            };
+            for ( int address = jumpTargets[i]; address <= i; address++ )
+                loop.cycles += addressCycles[address];
+            loops.push_back( loop );
+        }
+        printTop( "Top loops by cycles", "iterations", "loop", loops );
+
+        // Opcodes
+        std::vector<Entry> opcodes;
+        for ( int i = 0; i < 0x100; i++ ) {
+            if ( opcodeCounts[i] == 0 )
+                continue;
+            char name[8];
+            snprintf( name, sizeof( name ), "%02X", i );
+            opcodes.push_back( {
+                name, opcodeCounts[i] * instructionCycles[i], opcodeCounts[i]
+            } );
+        }
+        printTop( "Top opcodes by cycles", "count", "opcode", opcodes );
+
+        // Addresses
+        std::vector<Entry> addresses;
+        for ( int i = 0; i < BOB3K_SIZE; i++ ) {
+            if ( addressCounts[i] != 0 )
+                addresses.push_back( {
+                    Symbolize( i ), addressCycles[i], addressCounts[i]
+                } );
+        }
+        printTop( "Hot addresses", "count", "address", addresses );
+    }
+
+}
+
+#endif
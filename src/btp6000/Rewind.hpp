@@ -0,0 +1,246 @@
+/*
+* Copyright © 2025 Micro-16 Team
+* 
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the “Software”), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+* 
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+* 
+* THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+#ifndef REWIND_HPP
+#define REWIND_HPP
+
+// Rewind buffer: a snapshot of the CPU and memory after every frame, for the
+// last `capacity` frames. Every `keyframeInterval` frames the memory is stored
+// whole (a keyframe), and the frames in between only store the bytes that
+// changed since the frame before, XORed with their old value and run-length
+// encoded, which is usually a few hundred bytes.
+//
+// Because the deltas are XORs they work in both directions: stepping back a
+// frame undoes one delta. Stepping back over a keyframe rebuilds the frame
+// before it from the previous keyframe. Old frames are dropped a keyframe
+// group at a time, so memory stays bounded.
+//
+// Delta format, repeated until the end:
+//     WORD skip   // Unchanged bytes
+//     WORD length // Changed bytes that follow
+//     BYTE xor[length]
+
+#include <deque>
+#include <vector>
+
+#include "stdint.h"
+#include "string.h"
+
+#include "Btp.hpp"
+
+// Unchanged bytes that end a run of changed ones
+#define REWIND_MIN_SKIP 4
+
+// The Better Than Pico 6000 namespace
+namespace btp {
+
+    // Snapshots of the last frames
+    class RewindBuffer {
+    public:
+        // Keeps up to `capacity` frames with a keyframe every
+        // `keyframeInterval` frames
+        RewindBuffer( uint32_t capacity, uint32_t keyframeInterval )
+            : capacity( capacity ), keyframeInterval( keyframeInterval ),
+              current( BOB3K_SIZE ) {}
+
+        // Snapshots the state at the end of a frame
+        void Push( BetterThanPico &cpu, const Bob3k &memory );
+
+        // Goes back one frame: drops the newest snapshot and restores the one
+        // before it. Returns false if there is nothing to go back to.
+        bool Rewind( BetterThanPico &cpu, Bob3k &memory );
+
+        // Forgets all frames
+        void Clear() {
+            frames.clear();
+        }
+
+        // Number of frames that can be restored
+        uint32_t Count() const {
+            return frames.size();
+        }
+
+        // Bytes used by the snapshots
+        size_t Size() const {
+            size_t size = current.size();
+            for ( const Frame &frame : frames )
+                size += sizeof( Frame ) + frame.memory.capacity();
+            return size;
+        }
+
+    private:
+        // One frame's snapshot
+        struct Frame {
+            CpuState cpu;
+            bool keyframe;
+            std::vector<uint8_t> memory; // Delta from the previous frame, or
+                                         // from zeroed memory for keyframes
+        };
+
+        uint32_t capacity;
+        uint32_t keyframeInterval;
+        uint32_t sinceKeyframe = 0; // Frames pushed since the last keyframe
+
+        std::deque<Frame> frames;     // Oldest first, starting at a keyframe
+        std::vector<uint8_t> current; // Memory of the newest frame
+
+        // Encodes the XOR of two memories
+        static void Encode(
+            const uint8_t *from,
+            const uint8_t *to,
+            std::vector<uint8_t> &delta
+        );
+
+        // XORs a delta into memory
+        static void Apply( const std::vector<uint8_t> &delta, uint8_t *memory );
+    };
+
+    // Encodes the XOR of two memories
+    inline void RewindBuffer::Encode(
+        const uint8_t *from,
+        const uint8_t *to,
+        std::vector<uint8_t> &delta
+    ) {
+        delta.clear();
+
+        uint32_t i = 0;
+        while ( i < BOB3K_SIZE ) {
+            // Skip unchanged bytes, eight at a time while possible
+            uint32_t start = i;
+            while ( i + 8 <= BOB3K_SIZE ) {
+                uint64_t a, b;
+                memcpy( &a, from + i, 8 );
+                memcpy( &b, to + i, 8 );
+                if ( a != b )
+                    break;
+                i += 8;
+            }
+            while ( i < BOB3K_SIZE && from[i] == to[i] )
+                i++;
+            if ( i == BOB3K_SIZE )
+                break;
+            uint32_t skip = i - start;
+
+            // Changed bytes, up to REWIND_MIN_SKIP unchanged ones in a row
+            uint32_t first = i, unchanged = 0;
+            while ( i < BOB3K_SIZE && i - first < 0xFFFF ) {
+                if ( from[i] == to[i] ) {
+                    if ( ++unchanged == REWIND_MIN_SKIP )
+                        break;
+                }
+                else
+                    unchanged = 0;
+                i++;
+            }
+            if ( unchanged == REWIND_MIN_SKIP )
+                i -= REWIND_MIN_SKIP - 1;
+            uint32_t length = i - first;
+
+            delta.push_back( (uint8_t)skip );
+            delta.push_back( (uint8_t)( skip >> 8 ) );
+            delta.push_back( (uint8_t)length );
+            delta.push_back( (uint8_t)( length >> 8 ) );
+            for ( uint32_t j = first; j < i; j++ )
+                delta.push_back( from[j] ^ to[j] );
+        }
+
+        delta.shrink_to_fit();
+    }
+
+    // XORs a delta into memory
+    inline void RewindBuffer::Apply(
+        const std::vector<uint8_t> &delta,
+        uint8_t *memory
+    ) {
+        uint32_t address = 0;
+        size_t i = 0;
+        while ( i < delta.size() ) {
+            address += delta[i] | ( delta[i + 1] << 8 );
+            uint32_t length = delta[i + 2] | ( delta[i + 3] << 8 );
+            i += 4;
+
+            for ( uint32_t j = 0; j < length; j++ )
+                memory[address++] ^= delta[i++];
+        }
+    }
+
+    // Snapshots the state at the end of a frame
+    inline void RewindBuffer::Push( BetterThanPico &cpu, const Bob3k &memory ) {
+        Frame frame;
+        frame.cpu = cpu.GetState();
+        frame.keyframe = frames.empty() || sinceKeyframe >= keyframeInterval;
+
+        if ( frame.keyframe ) {
+            static const uint8_t zeroes[BOB3K_SIZE] = {};
+            Encode( zeroes, memory.data(), frame.memory );
+            sinceKeyframe = 0;
+        }
+        else
+            Encode( current.data(), memory.data(), frame.memory );
+        sinceKeyframe++;
+
+        memcpy( current.data(), memory.data(), BOB3K_SIZE );
+        frames.push_back( std::move( frame ) );
+
+        // Drop the oldest frames a keyframe group at a time
+        if ( frames.size() > capacity ) {
+            do
+                frames.pop_front();
+            while ( !frames.empty() && !frames.front().keyframe );
+        }
+    }
+
+    // Goes back one frame: drops the newest snapshot and restores the one
+    // before it
+    inline bool RewindBuffer::Rewind( BetterThanPico &cpu, Bob3k &memory ) {
+        if ( frames.size() < 2 )
+            return false;
+
+        Frame dropped = std::move( frames.back() );
+        frames.pop_back();
+
+        if ( !dropped.keyframe ) {
+            // Undo the delta
+            Apply( dropped.memory, current.data() );
+            sinceKeyframe--;
+        }
+        else {
+            // Rebuild from the previous keyframe
+            size_t keyframe = frames.size() - 1;
+            while ( !frames[keyframe].keyframe )
+                keyframe--;
+
+            memset( current.data(), 0, BOB3K_SIZE );
+            for ( size_t i = keyframe; i < frames.size(); i++ )
+                Apply( frames[i].memory, current.data() );
+            sinceKeyframe = frames.size() - keyframe;
+        }
+
+        cpu.SetState( frames.back().cpu );
+        memory.Restore( current.data() );
+        return true;
+    }
+
+}
+
+#endif
@@ -0,0 +1,145 @@
+/*
+* Copyright © 2025 Micro-16 Team
+* 
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the “Software”), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+* 
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+* 
+* THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+#ifndef SAVESTATE_HPP
+#define SAVESTATE_HPP
+
+// Save states: the CPU's registers and all of memory in one blob. Blobs are
+// the same in memory and on disk, so a state saved to a buffer can be written
+// out as is and loaded back from a file.
+//
+// Save state format (little endian):
+//     StateHeader
+//     CpuState
+//     Memory (BOB3K_SIZE bytes)
+
+#include <fstream>
+#include <vector>
+
+#include "stdint.h"
+#include "string.h"
+
+#include "Btp.hpp"
+
+#define BTP_STATE_MAGIC   "BTPS"
+#define BTP_STATE_VERSION 2
+
+// The Better Than Pico 6000 namespace
+namespace btp {
+
+    // Start of a save state
+    struct StateHeader {
+        char magic[4];       // BTP_STATE_MAGIC
+        uint16_t version;    // BTP_STATE_VERSION
+        uint16_t cpuSize;    // sizeof( CpuState )
+        uint32_t memorySize; // BOB3K_SIZE
+    };
+
+    // Bytes in a save state
+    constexpr size_t STATE_SIZE =
+        sizeof( StateHeader ) + sizeof( CpuState ) + BOB3K_SIZE;
+
+    // Writes a save state into `blob`, which must hold STATE_SIZE bytes, and
+    // returns its size
+    inline size_t SaveState(
+        BetterThanPico &cpu,
+        const Bob3k &memory,
+        uint8_t *blob
+    ) {
+        StateHeader header;
+        memcpy( header.magic, BTP_STATE_MAGIC, sizeof( header.magic ) );
+        header.version = BTP_STATE_VERSION;
+        header.cpuSize = sizeof( CpuState );
+        header.memorySize = BOB3K_SIZE;
+
+        CpuState state = cpu.GetState();
+
+        memcpy( blob, &header, sizeof( header ) );
+        memcpy( blob + sizeof( header ), &state, sizeof( state ) );
+        memcpy(
+            blob + sizeof( header ) + sizeof( state ),
+            memory.data(), BOB3K_SIZE
+        );
+        return STATE_SIZE;
+    }
+
+    // Restores a save state, returns false (changing nothing) if `blob` is
+    // not a save state of this version
+    inline bool LoadState(
+        BetterThanPico &cpu,
+        Bob3k &memory,
+        const uint8_t *blob,
+        size_t size
+    ) {
+        if ( size < STATE_SIZE )
+            return false;
+
+        StateHeader header;
+        memcpy( &header, blob, sizeof( header ) );
+        if (
+            memcmp( header.magic, BTP_STATE_MAGIC, sizeof( header.magic ) ) ||
+            header.version != BTP_STATE_VERSION ||
+            header.cpuSize != sizeof( CpuState ) ||
+            header.memorySize != BOB3K_SIZE
+        )
+            return false;
+
+        CpuState state;
+        memcpy( &state, blob + sizeof( header ), sizeof( state ) );
+        cpu.SetState( state );
+        memory.Restore( blob + sizeof( header ) + sizeof( state ) );
+        return true;
+    }
+
+    // Writes a save state to a file, returns false if it could not be written
+    inline bool SaveStateFile(
+        BetterThanPico &cpu,
+        const Bob3k &memory,
+        const char *outputFile
+    ) {
+        std::vector<uint8_t> blob( STATE_SIZE );
+        SaveState( cpu, memory, blob.data() );
+
+        std::ofstream file( outputFile, std::ios::binary );
+        file.write( (const char*)blob.data(), blob.size() );
+        return (bool)file;
+    }
+
+    // Restores a save state from a file, returns false if it could not be read
+    inline bool LoadStateFile(
+        BetterThanPico &cpu,
+        Bob3k &memory,
+        const char *inputFile
+    ) {
+        std::ifstream file( inputFile, std::ios::binary );
+        std::vector<uint8_t> blob( STATE_SIZE );
+        file.read( (char*)blob.data(), blob.size() );
+        if ( !file )
+            return false;
+
+        return LoadState( cpu, memory, blob.data(), blob.size() );
+    }
+
+}
+
+#endif
@@ -0,0 +1,144 @@
+/*
+* Copyright © 2025 Micro-16 Team
+* 
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the “Software”), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+* 
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+* 
+* THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+#ifndef TRACE_HPP
+#define TRACE_HPP
+
+// Binary execution trace. While a Tracer is attached to a BetterThanPico,
+// every interpreted instruction writes one fixed-size TraceRecord into a ring
+// buffer allocated up front, so tracing a long run costs a store per
+// instruction instead of a printf. Dump() writes the newest records to a file
+// that btp6ktrace turns into text.
+//
+// Trace file format (little endian):
+//     TraceHeader
+//     TraceRecord[count], oldest first
+
+#include <fstream>
+
+#include "stdint.h"
+#include "string.h"
+
+#define BTP_TRACE_MAGIC   "BTPT"
+#define BTP_TRACE_VERSION 1
+
+// The Better Than Pico 6000 namespace
+namespace btp {
+
+    // State of the CPU just before an instruction ran
+    struct TraceRecord {
+        uint16_t CS, IP, SP;
+        uint16_t A, B, X, Y;
+        uint8_t opcode;
+        uint8_t flags;
+    };
+    static_assert( sizeof( TraceRecord ) == 16, "TraceRecord is not packed" );
+
+    // Start of a trace file
+    struct TraceHeader {
+        char magic[4];       // BTP_TRACE_MAGIC
+        uint16_t version;    // BTP_TRACE_VERSION
+        uint16_t recordSize; // sizeof( TraceRecord )
+        uint32_t count;      // Number of records that follow
+    };
+
+    // Ring buffer of the most recent TraceRecords
+    class Tracer {
+    public:
+        // Allocates room for at least `capacity` records (rounded up to a
+        // power of two)
+        Tracer( uint32_t capacity ) {
+            this->capacity = 1;
+            while ( this->capacity < capacity )
+                this->capacity <<= 1;
+            records = new TraceRecord[this->capacity];
+        }
+
+        // Frees the records
+        ~Tracer() {
+            delete[] records;
+        }
+
+        // Records are owned by the tracer
+        Tracer( const Tracer & ) = delete;
+        Tracer &operator=( const Tracer & ) = delete;
+
+        // Adds a record, overwriting the oldest one when full
+        void Record( const TraceRecord &record ) {
+            records[next++ & ( capacity - 1 )] = record;
+        }
+
+        // Forgets all records
+        void Clear() {
+            next = 0;
+        }
+
+        // Number of records held
+        uint32_t Count() const {
+            return next < capacity ? (uint32_t)next : capacity;
+        }
+
+        // Total number of records ever added, including overwritten ones
+        uint64_t Total() const {
+            return next;
+        }
+
+        // Writes the records to a trace file, returns false if it could not
+        // be written
+        bool Dump( const char *outputFile ) const {
+            std::ofstream file( outputFile, std::ios::binary );
+            if ( !file )
+                return false;
+
+            TraceHeader header;
+            memcpy( header.magic, BTP_TRACE_MAGIC, sizeof( header.magic ) );
+            header.version = BTP_TRACE_VERSION;
+            header.recordSize = sizeof( TraceRecord );
+            header.count = Count();
+            file.write( (const char*)&header, sizeof( header ) );
+
+            // Oldest first, which may wrap around the end of the buffer
+            uint32_t first = ( next - header.count ) & ( capacity - 1 );
+            uint32_t tail = capacity - first;
+            if ( tail > header.count )
+                tail = header.count;
+            file.write(
+                (const char*)( records + first ), tail * sizeof( TraceRecord )
+            );
+            file.write(
+                (const char*)records,
+                ( header.count - tail ) * sizeof( TraceRecord )
+            );
+
+            return (bool)file;
+        }
+
+    private:
+        TraceRecord *records;
+        uint32_t capacity;
+        uint64_t next = 0; // Index of the next record, never wraps
+    };
+
+}
+
+#endif
@@ -0,0 +1,183 @@
+/*
+* Copyright © 2025 Micro-16 Team
+* 
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the “Software”), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+* 
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+* 
+* THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+#ifndef CARTRIDGE_HPP
+#define CARTRIDGE_HPP
+
+// Reads btp6kasm objects (see the btp6kasm README) so that tools and runners
+// can load them into memory without the assembler.
+
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "stdint.h"
+#include "string.h"
+
+#include "../bob3000/Bob.hpp"
+
+// Chunk types (see the btp6kasm README)
+#define OBJECT_CHUNK_HEADER          0x00
+#define OBJECT_CHUNK_CODE            0x01
+#define OBJECT_METADATA_ENTRY_LENGTH 3
+
+// Cartridge namespace
+namespace cart {
+
+// An external label from the object header
+struct Label {
+    std::string name;
+    uint16_t address; // Linear address (origin + position)
+};
+
+// The code and labels of an object
+class Cartridge {
+public:
+    uint16_t origin = 0x0000;
+    std::vector<uint8_t> code;
+    std::vector<Label> labels; // In header order
+
+    // Empty constructor
+    Cartridge() {}
+
+    // Reads an object file, prints the problem and returns false if it
+    // cannot be read
+    bool Load( const std::string &objectFile );
+
+    // Returns a label by name, or nullptr
+    const Label *Find( const std::string &name ) const {
+        for ( const Label &label : labels ) {
+            if ( label.name == name )
+                return &label;
+        }
+        return nullptr;
+    }
+
+    // Copies the code to its origin
+    void Install( Bob3k &memory ) const {
+        memcpy( memory.data() + origin, code.data(), code.size() );
+        memory.MarkDirty( origin, code.size() );
+    }
+
+private:
+    // Reads the header chunk
+    bool ReadHeader( const std::vector<uint8_t> &chunk );
+};
+
+// Reads an object file, prints the problem and returns false if it cannot be
+// read
+inline bool Cartridge::Load( const std::string &objectFile ) {
+    std::ifstream file( objectFile, std::ios::binary );
+    if ( !file.is_open() ) {
+        std::cout << "File \"" << objectFile << "\" either does not exist or "
+            "cannot be opened.\n";
+        return false;
+    }
+
+    std::vector<uint8_t> object(
+        ( std::istreambuf_iterator<char>( file ) ),
+        std::istreambuf_iterator<char>()
+    );
+    if ( object.empty() || object[0] > object.size() ) {
+        std::cout << "ERROR: \"" << objectFile << "\" is not an object "
+            "file!\n";
+        return false;
+    }
+
+    // Metadata entries point at the chunks, which run until the next chunk
+    int metadataLength = object[0];
+    for (
+        int i = 1;
+        i + OBJECT_METADATA_ENTRY_LENGTH <= metadataLength;
+        i += OBJECT_METADATA_ENTRY_LENGTH
+    ) {
+        int next = i + OBJECT_METADATA_ENTRY_LENGTH;
+        size_t start = object[i + 1] | ( object[i + 2] << 8 );
+        size_t end = object.size();
+        if ( next + OBJECT_METADATA_ENTRY_LENGTH <= metadataLength )
+            end = object[next + 1] | ( object[next + 2] << 8 );
+
+        if ( start > end || end > object.size() ) {
+            std::cout << "ERROR: A chunk lies outside of the object!\n";
+            return false;
+        }
+
+        std::vector<uint8_t> chunk(
+            object.begin() + start,
+            object.begin() + end
+        );
+        if ( object[i] == OBJECT_CHUNK_HEADER ) {
+            if ( !ReadHeader( chunk ) )
+                return false;
+        }
+        else if ( object[i] == OBJECT_CHUNK_CODE )
+            code = chunk;
+    }
+
+    if ( code.size() > (size_t)( BOB3K_SIZE - origin ) ) {
+        std::cout << "ERROR: Code does not fit in memory!\n";
+        return false;
+    }
+
+    return true;
+}
+
+// Reads the header chunk
+inline bool Cartridge::ReadHeader( const std::vector<uint8_t> &chunk ) {
+    if ( chunk.size() < 6 ) {
+        std::cout << "ERROR: Header chunk is too short!\n";
+        return false;
+    }
+
+    origin = chunk[0] | ( chunk[1] << 8 );
+
+    // Label section: its size (counting the size itself) followed by
+    // null-terminated names and their positions in the code
+    size_t end = 4 + ( chunk[4] | ( chunk[5] << 8 ) );
+    if ( end > chunk.size() )
+        end = chunk.size();
+
+    for ( size_t i = 6; i < end; i += 2 ) {
+        Label label;
+        while ( i < end && chunk[i] != 0 )
+            label.name += (char)chunk[i++];
+        i++;
+
+        if ( i + 2 > end ) {
+            std::cout << "ERROR: Label \"" << label.name << "\" is cut "
+                "off!\n";
+            return false;
+        }
+
+        label.address = origin + ( chunk[i] | ( chunk[i + 1] << 8 ) );
+        labels.push_back( label );
+    }
+
+    return true;
+}
+
+}
+
+#endif
@@ -0,0 +1,227 @@
+/*
+* Copyright © 2025 Micro-16 Team
+* 
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the “Software”), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+* 
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+* 
+* THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+
+#ifndef CONSOLEPOOL_HPP
+#define CONSOLEPOOL_HPP
+
+// Many headless consoles stepped a frame at a time on a pool of threads. The
+// consoles' inputs, framebuffers and frame results each live in one
+// contiguous array, so a caller can fill or read all of them at once.
+//
+// Each thread starts a frame with its own range of consoles and, once that
+// is done, steals consoles from the ranges of the others. Every range is just
+// an atomic cursor, so the owner and thieves take consoles from it the same
+// way and a slow console never leaves the other threads idle.
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "stdint.h"
+
+#include "HeadlessConsole.hpp"
+
+// Micro-16 console namespace
+namespace micro16 {
+
+// Headless consoles stepped in parallel
+class ConsolePool {
+public:
+    // Creates `count` consoles, stepped by `threads` threads including the
+    // caller's (0 for one per core)
+    ConsolePool( uint32_t count, uint32_t threads = 0 );
+
+    // Stops the threads
+    ~ConsolePool();
+
+    // Threads and consoles point into the pool
+    ConsolePool( const ConsolePool & ) = delete;
+    ConsolePool &operator=( const ConsolePool & ) = delete;
+
+    // Number of consoles
+    uint32_t Count() const {
+        return consoles.size();
+    }
+
+    // Number of threads stepping them, including the caller's
+    uint32_t Threads() const {
+        return workerCount;
+    }
+
+    // Returns a console
+    HeadlessConsole &operator[]( uint32_t index ) {
+        return *consoles[index];
+    }
+
+    // Inserts a cartridge into every console
+    void Insert( const cart::Cartridge &cartridge ) {
+        for ( auto &console : consoles )
+            console->Insert( cartridge );
+    }
+
+    // Input of every console, read at the start of each frame
+    MiDi16::Input *Inputs() {
+        return inputs.data();
+    }
+
+    // Framebuffers of every console, SCREEN_PIXELS colors each
+    const MiDi16::Color *Framebuffers() const {
+        return framebuffers.data();
+    }
+
+    // What the last frame ran on every console
+    const btp::RunResult *Results() const {
+        return results.data();
+    }
+
+    // Runs a frame on every console, returns once all are done
+    void RunFrame();
+
+private:
+    // A range of consoles to step, on its own cache line
+    struct alignas( 64 ) Range {
+        std::atomic<uint32_t> next;
+        uint32_t end;
+    };
+
+    std::vector<std::unique_ptr<HeadlessConsole>> consoles;
+    std::vector<MiDi16::Input> inputs;
+    std::vector<MiDi16::Color> framebuffers;
+    std::vector<btp::RunResult> results;
+
+    uint32_t workerCount;
+    std::unique_ptr<Range[]> ranges;
+    std::vector<std::thread> threads;
+
+    std::mutex mutex;
+    std::condition_variable started, finished;
+    uint64_t frame = 0;   // Bumped to start a frame
+    uint32_t busy = 0;    // Threads still stepping consoles
+    bool stopping = false;
+
+    // Waits for frames and steps consoles until the pool is destroyed
+    void Work( uint32_t worker );
+
+    // Steps the worker's own range, then steals from the others
+    void Step( uint32_t worker );
+};
+
+// Creates `count` consoles, stepped by `threads` threads including the
+// caller's
+inline ConsolePool::ConsolePool( uint32_t count, uint32_t threads )
+    : inputs( count ), framebuffers( (size_t)count * SCREEN_PIXELS ),
+      results( count ) {
+    consoles.reserve( count );
+    for ( uint32_t i = 0; i < count; i++ )
+        consoles.emplace_back( new HeadlessConsole(
+            framebuffers.data() + (size_t)i * SCREEN_PIXELS
+        ) );
+
+    if ( threads == 0 )
+        threads = std::max( std::thread::hardware_concurrency(), 1u );
+    workerCount = std::max( std::min( threads, count ), 1u );
+    ranges.reset( new Range[workerCount] );
+
+    // The caller is worker 0
+    for ( uint32_t i = 1; i < workerCount; i++ )
+        this->threads.emplace_back( &ConsolePool::Work, this, i );
+}
+
+// Stops the threads
+inline ConsolePool::~ConsolePool() {
+    {
+        std::lock_guard<std::mutex> lock( mutex );
+        stopping = true;
+    }
+    started.notify_all();
+    for ( std::thread &thread : threads )
+        thread.join();
+}
+
+// Runs a frame on every console, returns once all are done
+inline void ConsolePool::RunFrame() {
+    uint32_t count = consoles.size();
+    for ( uint32_t i = 0; i < workerCount; i++ ) {
+        ranges[i].next.store(
+            (uint64_t)count * i / workerCount, std::memory_order_relaxed
+        );
+        ranges[i].end = (uint64_t)count * ( i + 1 ) / workerCount;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock( mutex );
+        frame++;
+        busy = workerCount - 1;
+    }
+    started.notify_all();
+
+    Step( 0 );
+
+    std::unique_lock<std::mutex> lock( mutex );
+    finished.wait( lock, [this] { return busy == 0; } );
+}
+
+// Waits for frames and steps consoles until the pool is destroyed
+inline void ConsolePool::Work( uint32_t worker ) {
+    uint64_t seen = 0;
+    while ( true ) {
+        {
+            std::unique_lock<std::mutex> lock( mutex );
+            started.wait(
+                lock, [&] { return stopping || frame != seen; }
+            );
+            if ( stopping )
+                return;
+            seen = frame;
+        }
+
+        Step( worker );
+
+        std::lock_guard<std::mutex> lock( mutex );
+        if ( --busy == 0 )
+            finished.notify_one();
+    }
+}
+
+// Steps the worker's own range, then steals from the others
+inline void ConsolePool::Step( uint32_t worker ) {
+    for ( uint32_t i = 0; i < workerCount; i++ ) {
+        Range &range = ranges[( worker + i ) % workerCount];
+
+        uint32_t console;
+        while (
+            ( console = range.next.fetch_add( 1, std::memory_order_relaxed ) )
+            < range.end
+        )
+            results[console] = consoles[console]->RunFrame( inputs[console] );
+    }
+}
+
+}
+
+#endif
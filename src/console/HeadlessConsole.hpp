@@ -0,0 +1,100 @@
+/*
+* Copyright © 2025 Micro-16 Team
+* 
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the “Software”), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+* 
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+* 
+* THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+
+#ifndef HEADLESSCONSOLE_HPP
+#define HEADLESSCONSOLE_HPP
+
+// A console without a window: memory, CPU and PGU drawing into plain memory.
+// Needs MIDI16_HEADLESS, so that the PGU draws into a HeadlessDisplay16
+// surface.
+
+#ifndef MIDI16_HEADLESS
+#error "HeadlessConsole.hpp needs MIDI16_HEADLESS to be defined"
+#endif
+
+#include "stdint.h"
+#include "string.h"
+
+#ifndef SCREEN_RESOLUTION
+#define SCREEN_RESOLUTION 128
+#endif
+
+#include "../bob3000/Bob.hpp"
+#include "../btp6000/Btp.hpp"
+#include "../pgu7000/Pgu.hpp"
+#include "../cartridge/Cartridge.hpp"
+#include "../replay/Replay.hpp"
+
+// Micro-16 console namespace
+namespace micro16 {
+
+constexpr int SCREEN_PIXELS = SCREEN_RESOLUTION * SCREEN_RESOLUTION;
+
+// A console without a window
+class HeadlessConsole {
+public:
+    Bob3k memory;
+    btp::BetterThanPico cpu;
+    MiDi16::Surface screen;
+    pgu::PixelGraphicsUnit gpu{ &screen };
+
+    // Connects the CPU and PGU to memory. The screen draws into `pixels` if
+    // given, which must hold SCREEN_PIXELS colors.
+    HeadlessConsole( MiDi16::Color *pixels = nullptr )
+        : screen( SCREEN_RESOLUTION, SCREEN_RESOLUTION, pixels ) {
+        cpu.SetMemory( &memory );
+        gpu.SetMemory( &memory );
+    }
+
+    // Starts the CPU at the cartridge's main label, or at its origin
+    void Insert( const cart::Cartridge &cartridge ) {
+        memset( memory.data(), 0, BOB3K_SIZE );
+        memory.MarkDirty( 0, BOB3K_SIZE );
+        cpu.Reset();
+        gpu.SetMemory( &memory ); // Writes the built in sprite and palette
+        cartridge.Install( memory );
+
+        const cart::Label *main = cartridge.Find( "main" );
+        uint16_t entry = main != nullptr ? main->address : cartridge.origin;
+        cpu.CS = entry >> 4;
+        cpu.IP = entry & 0xF;
+    }
+
+    // Same as Micro16::Update() and Micro16::Draw()
+    btp::RunResult RunFrame( const MiDi16::Input &input ) {
+        replay::WriteInput( input, memory );
+        btp::RunResult result = cpu.RunFrame();
+
+        gpu.Latch();
+        screen.Clear();
+        gpu.Render();
+        memory.ClearDirty();
+
+        return result;
+    }
+};
+
+}
+
+#endif
@@ -0,0 +1,453 @@
+/*
+* Copyright © 2025 Micro-16 Team
+* 
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the “Software”), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+* 
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+* 
+* THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#ifndef PGU_KERNELS_HPP
+#define PGU_KERNELS_HPP
+
+// Kernels that turn 8x8 tiles from the 2 bitplanes sprites are stored in into
+// a palette index per pixel, and tiles or rows of indices into pixels. Each
+// comes as plain C++, SSE2 or SSSE3 and AVX2, and the PGU uses the fastest
+// set the host runs. Every set must give exactly the same results.
+
+#include "stdint.h"
+#include "string.h"
+
+#ifdef MIDI16_HEADLESS
+#include "MiDi16/HeadlessDisplay16.hpp"
+#else
+#include "MiDi16/MicroDisplay16.hpp"
+#endif
+
+// The vector kernels need an x86-64 GCC or Clang; SSSE3 and AVX2 are checked
+// for at run time, so the rest of the program does not need to be built with
+// -mssse3 or -mavx2
+#if defined( __x86_64__ ) && ( defined( __GNUC__ ) || defined( __clang__ ) )
+#define PGU_SIMD
+#include <immintrin.h>
+#endif
+
+// PGU namespace
+namespace pgu {
+
+constexpr int
+    TILE_WIDTH         = 8, // Tiles are square
+    TILE_BITPLANE_SIZE = 2 * TILE_WIDTH, // A byte per row in each bitplane
+    TILE_PIXELS        = TILE_WIDTH * TILE_WIDTH;
+
+// Spreads each bit of a bitplane byte into the low bit of its own byte, the
+// most significant bit (the leftmost pixel) into the first, so that a row of
+// a sprite decodes into 8 palette indices with two lookups
+struct BitplaneTable {
+    uint64_t spread[256];
+
+    constexpr BitplaneTable() : spread() {
+        for ( int byte = 0; byte < 256; byte++ )
+            for ( int pixel = 0; pixel < TILE_WIDTH; pixel++ )
+                if ( byte >> ( TILE_WIDTH - 1 - pixel ) & 1 )
+                    spread[byte] |= (uint64_t)1 << ( pixel * 8 );
+    }
+
+    // Returns the palette indices of a sprite row, the leftmost pixel's in
+    // the lowest byte
+    constexpr uint64_t Decode( uint8_t lsb, uint8_t msb ) const {
+        return spread[lsb] | spread[msb] << 1;
+    }
+};
+
+constexpr BitplaneTable bitplanes;
+
+// A sprite as the scanline kernels draw it, at x and y. Row j of it is the 8
+// palette indices at rows + j * step, of which only the columns [left,
+// right) are on the screen.
+struct LineSprite {
+    const uint8_t *rows;
+    const MiDi16::Color *colors;
+    int x, y;
+    int step;
+    int left, right;
+};
+
+// A set of kernels
+struct Kernels {
+    const char *name;
+
+    // Decodes the 16 bytes of a sprite, the lsb bitplane then the msb one,
+    // into 64 palette indices, row by row
+    void ( *DecodeTile )( const uint8_t *bitplanes, uint8_t *tile );
+
+    // Writes the colors of a tile of palette indices, each row `stride`
+    // pixels after the last
+    void ( *ColorTile )(
+        const uint8_t *tile, const MiDi16::Color *colors,
+        MiDi16::Color *pixels, int stride
+    );
+
+    // Writes the colors of the sprites whose bits are set in `entries` over
+    // a scanline, from the highest bit to the lowest, leaving the pixels of
+    // index 0 alone
+    void ( *BlendLine )(
+        const LineSprite *sprites, uint64_t entries, int line,
+        MiDi16::Color *pixels
+    );
+};
+
+enum KernelLevel {
+    KERNELS_SCALAR,
+    KERNELS_SSSE3, // SSE2 decoding, SSSE3 coloring
+    KERNELS_AVX2,
+    KERNEL_LEVEL_COUNT,
+};
+
+// Decodes a tile a row at a time through the bitplane table
+inline void ScalarDecodeTile( const uint8_t *planes, uint8_t *tile ) {
+    for ( int j = 0; j < TILE_WIDTH; j++ ) {
+        uint64_t indices =
+            bitplanes.Decode( planes[j], planes[j + TILE_WIDTH] );
+        memcpy( tile + j * TILE_WIDTH, &indices, TILE_WIDTH );
+    }
+}
+
+// Colors a tile a pixel at a time
+inline void ScalarColorTile(
+    const uint8_t *tile, const MiDi16::Color *colors,
+    MiDi16::Color *pixels, int stride
+) {
+    for ( int j = 0; j < TILE_WIDTH; j++ )
+        for ( int i = 0; i < TILE_WIDTH; i++ )
+            pixels[j * stride + i] = colors[tile[j * TILE_WIDTH + i]];
+}
+
+// Returns the highest entry set and clears it
+inline int NextEntry( uint64_t &entries ) {
+    int entry = 63 - __builtin_clzll( entries );
+    entries &= ~( (uint64_t)1 << entry );
+    return entry;
+}
+
+// Blends the part of a sprite's row that is on the screen a pixel at a time
+inline void BlendRowPart(
+    const LineSprite &sprite, const uint8_t *indices, MiDi16::Color *pixels
+) {
+    for ( int i = sprite.left; i < sprite.right; i++ )
+        if ( indices[i] )
+            pixels[sprite.x + i] = sprite.colors[indices[i]];
+}
+
+// Blends a scanline a pixel at a time
+inline void ScalarBlendLine(
+    const LineSprite *sprites, uint64_t entries, int line,
+    MiDi16::Color *pixels
+) {
+    while ( entries ) {
+        const LineSprite &sprite = sprites[NextEntry( entries )];
+        BlendRowPart(
+            sprite, sprite.rows + ( line - sprite.y ) * sprite.step, pixels
+        );
+    }
+}
+
+#ifdef PGU_SIMD
+
+// Returns the palette index of every byte, given bytes that each hold the
+// lsb and msb bitplane rows of their pixel
+inline __m128i Sse2Indices( __m128i lsb, __m128i msb ) {
+    // The bit of each pixel, leftmost first
+    const __m128i bits = _mm_set_epi8(
+        1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128
+    );
+    __m128i low = _mm_cmpeq_epi8( _mm_and_si128( lsb, bits ), bits );
+    __m128i high = _mm_cmpeq_epi8( _mm_and_si128( msb, bits ), bits );
+    return _mm_or_si128(
+        _mm_and_si128( low, _mm_set1_epi8( 1 ) ),
+        _mm_and_si128( high, _mm_set1_epi8( 2 ) )
+    );
+}
+
+// Decodes a tile two rows at a time, repeating each row's bitplane bytes
+// across its 8 pixels with unpacks
+inline void Sse2DecodeTile( const uint8_t *planes, uint8_t *tile ) {
+    __m128i rows = _mm_loadu_si128( (const __m128i *)planes );
+
+    // Each row twice, then each row 4 times
+    __m128i lsb = _mm_unpacklo_epi8( rows, rows );
+    __m128i msb = _mm_unpackhi_epi8( rows, rows );
+    __m128i lsbTop = _mm_unpacklo_epi16( lsb, lsb );
+    __m128i lsbBottom = _mm_unpackhi_epi16( lsb, lsb );
+    __m128i msbTop = _mm_unpacklo_epi16( msb, msb );
+    __m128i msbBottom = _mm_unpackhi_epi16( msb, msb );
+
+    // Each row 8 times, two rows to a vector
+    __m128i *out = (__m128i *)tile;
+    _mm_storeu_si128( out + 0, Sse2Indices(
+        _mm_unpacklo_epi32( lsbTop, lsbTop ),
+        _mm_unpacklo_epi32( msbTop, msbTop )
+    ) );
+    _mm_storeu_si128( out + 1, Sse2Indices(
+        _mm_unpackhi_epi32( lsbTop, lsbTop ),
+        _mm_unpackhi_epi32( msbTop, msbTop )
+    ) );
+    _mm_storeu_si128( out + 2, Sse2Indices(
+        _mm_unpacklo_epi32( lsbBottom, lsbBottom ),
+        _mm_unpacklo_epi32( msbBottom, msbBottom )
+    ) );
+    _mm_storeu_si128( out + 3, Sse2Indices(
+        _mm_unpackhi_epi32( lsbBottom, lsbBottom ),
+        _mm_unpackhi_epi32( msbBottom, msbBottom )
+    ) );
+}
+
+#if defined( __clang__ )
+#pragma clang attribute push ( \
+    __attribute__(( target( "ssse3" ) )), apply_to = function )
+#else
+#pragma GCC push_options
+#pragma GCC target( "ssse3" )
+#endif
+
+// Colors a tile half a row at a time. The 4 colors fit in 16 bytes, so each
+// pixel's bytes are shuffled straight out of them.
+inline void Ssse3ColorTile(
+    const uint8_t *tile, const MiDi16::Color *colors,
+    MiDi16::Color *pixels, int stride
+) {
+    __m128i palette = _mm_loadu_si128( (const __m128i *)colors );
+
+    // Each pixel's index 4 times, then the byte of the color to take
+    const __m128i left = _mm_set_epi64x(
+        0x0303030302020202, 0x0101010100000000
+    );
+    const __m128i right = _mm_set_epi64x(
+        0x0707070706060606, 0x0505050504040404
+    );
+    const __m128i bytes = _mm_set1_epi32( 0x03020100 );
+
+    for ( int j = 0; j < TILE_WIDTH; j++ ) {
+        __m128i row =
+            _mm_loadl_epi64( (const __m128i *)( tile + j * TILE_WIDTH ) );
+        __m128i *out = (__m128i *)( pixels + j * stride );
+        _mm_storeu_si128( out, _mm_shuffle_epi8( palette, _mm_or_si128(
+            _mm_slli_epi16( _mm_shuffle_epi8( row, left ), 2 ), bytes
+        ) ) );
+        _mm_storeu_si128( out + 1, _mm_shuffle_epi8( palette, _mm_or_si128(
+            _mm_slli_epi16( _mm_shuffle_epi8( row, right ), 2 ), bytes
+        ) ) );
+    }
+}
+
+// Blends whole rows half at a time, keeping the pixels whose index is 0
+inline void Ssse3BlendLine(
+    const LineSprite *sprites, uint64_t entries, int line,
+    MiDi16::Color *pixels
+) {
+    // Each pixel's index 4 times, for each half of the row
+    const __m128i halves[2] = {
+        _mm_set_epi64x( 0x0303030302020202, 0x0101010100000000 ),
+        _mm_set_epi64x( 0x0707070706060606, 0x0505050504040404 ),
+    };
+    const __m128i bytes = _mm_set1_epi32( 0x03020100 );
+
+    while ( entries ) {
+        const LineSprite &sprite = sprites[NextEntry( entries )];
+        const uint8_t *row = sprite.rows + ( line - sprite.y ) * sprite.step;
+        if ( sprite.left != 0 || sprite.right != TILE_WIDTH ) {
+            BlendRowPart( sprite, row, pixels );
+            continue;
+        }
+
+        __m128i palette = _mm_loadu_si128( (const __m128i *)sprite.colors );
+        __m128i indices = _mm_loadl_epi64( (const __m128i *)row );
+        __m128i *out = (__m128i *)( pixels + sprite.x );
+        for ( int half = 0; half < 2; half++ ) {
+            __m128i spread = _mm_shuffle_epi8( indices, halves[half] );
+            __m128i color = _mm_shuffle_epi8(
+                palette, _mm_or_si128( _mm_slli_epi16( spread, 2 ), bytes )
+            );
+            __m128i keep = _mm_cmpeq_epi8( spread, _mm_setzero_si128() );
+            _mm_storeu_si128( out + half, _mm_or_si128(
+                _mm_and_si128( keep, _mm_loadu_si128( out + half ) ),
+                _mm_andnot_si128( keep, color )
+            ) );
+        }
+    }
+}
+
+#if defined( __clang__ )
+#pragma clang attribute pop
+#else
+#pragma GCC pop_options
+#endif
+
+#if defined( __clang__ )
+#pragma clang attribute push ( \
+    __attribute__(( target( "avx2" ) )), apply_to = function )
+#else
+#pragma GCC push_options
+#pragma GCC target( "avx2" )
+#endif
+
+// Returns the palette index of every byte, given bytes that each hold the
+// lsb and msb bitplane rows of their pixel
+inline __m256i Avx2Indices( __m256i lsb, __m256i msb ) {
+    // The bit of each pixel, leftmost first
+    const __m256i bits = _mm256_set1_epi64x( 0x0102040810204080 );
+    __m256i low = _mm256_cmpeq_epi8( _mm256_and_si256( lsb, bits ), bits );
+    __m256i high = _mm256_cmpeq_epi8( _mm256_and_si256( msb, bits ), bits );
+    return _mm256_or_si256(
+        _mm256_and_si256( low, _mm256_set1_epi8( 1 ) ),
+        _mm256_and_si256( high, _mm256_set1_epi8( 2 ) )
+    );
+}
+
+// Decodes a tile 4 rows at a time, repeating each row's bitplane bytes
+// across its 8 pixels with a byte shuffle
+inline void Avx2DecodeTile( const uint8_t *planes, uint8_t *tile ) {
+    __m256i rows = _mm256_broadcastsi128_si256(
+        _mm_loadu_si128( (const __m128i *)planes )
+    );
+
+    // Byte j of the lsb plane for rows j to j + 3, 8 times each
+    const __m256i top = _mm256_setr_epi64x(
+        0x0000000000000000, 0x0101010101010101,
+        0x0202020202020202, 0x0303030303030303
+    );
+    const __m256i bottom = _mm256_add_epi8( top, _mm256_set1_epi8( 4 ) );
+    const __m256i msb = _mm256_set1_epi8( TILE_WIDTH );
+
+    __m256i *out = (__m256i *)tile;
+    _mm256_storeu_si256( out, Avx2Indices(
+        _mm256_shuffle_epi8( rows, top ),
+        _mm256_shuffle_epi8( rows, _mm256_add_epi8( top, msb ) )
+    ) );
+    _mm256_storeu_si256( out + 1, Avx2Indices(
+        _mm256_shuffle_epi8( rows, bottom ),
+        _mm256_shuffle_epi8( rows, _mm256_add_epi8( bottom, msb ) )
+    ) );
+}
+
+// Colors a tile a row at a time. The 4 colors fit in 16 bytes, so each
+// pixel's bytes are shuffled straight out of them.
+inline void Avx2ColorTile(
+    const uint8_t *tile, const MiDi16::Color *colors,
+    MiDi16::Color *pixels, int stride
+) {
+    __m256i palette = _mm256_broadcastsi128_si256(
+        _mm_loadu_si128( (const __m128i *)colors )
+    );
+
+    // Each pixel's index 4 times, then the byte of the color to take
+    const __m256i spread = _mm256_setr_epi64x(
+        0x0101010100000000, 0x0303030302020202,
+        0x0505050504040404, 0x0707070706060606
+    );
+    const __m256i bytes = _mm256_set1_epi32( 0x03020100 );
+
+    for ( int j = 0; j < TILE_WIDTH; j++ ) {
+        __m256i row = _mm256_broadcastsi128_si256(
+            _mm_loadl_epi64( (const __m128i *)( tile + j * TILE_WIDTH ) )
+        );
+        __m256i indices = _mm256_shuffle_epi8( row, spread );
+        __m256i select = _mm256_or_si256(
+            _mm256_slli_epi16( indices, 2 ), bytes
+        );
+        _mm256_storeu_si256(
+            (__m256i *)( pixels + j * stride ),
+            _mm256_shuffle_epi8( palette, select )
+        );
+    }
+}
+
+// Blends whole rows at once, keeping the pixels whose index is 0
+inline void Avx2BlendLine(
+    const LineSprite *sprites, uint64_t entries, int line,
+    MiDi16::Color *pixels
+) {
+    // Each pixel's index 4 times, then the byte of the color to take
+    const __m256i spread = _mm256_setr_epi64x(
+        0x0101010100000000, 0x0303030302020202,
+        0x0505050504040404, 0x0707070706060606
+    );
+    const __m256i bytes = _mm256_set1_epi32( 0x03020100 );
+
+    while ( entries ) {
+        const LineSprite &sprite = sprites[NextEntry( entries )];
+        const uint8_t *row = sprite.rows + ( line - sprite.y ) * sprite.step;
+        if ( sprite.left != 0 || sprite.right != TILE_WIDTH ) {
+            BlendRowPart( sprite, row, pixels );
+            continue;
+        }
+
+        __m256i palette = _mm256_broadcastsi128_si256(
+            _mm_loadu_si128( (const __m128i *)sprite.colors )
+        );
+        __m256i indices = _mm256_shuffle_epi8(
+            _mm256_broadcastsi128_si256(
+                _mm_loadl_epi64( (const __m128i *)row )
+            ),
+            spread
+        );
+        __m256i color = _mm256_shuffle_epi8( palette, _mm256_or_si256(
+            _mm256_slli_epi16( indices, 2 ), bytes
+        ) );
+
+        __m256i keep = _mm256_cmpeq_epi8( indices, _mm256_setzero_si256() );
+        __m256i *out = (__m256i *)( pixels + sprite.x );
+        _mm256_storeu_si256(
+            out, _mm256_blendv_epi8( color, _mm256_loadu_si256( out ), keep )
+        );
+    }
+}
+
+#if defined( __clang__ )
+#pragma clang attribute pop
+#else
+#pragma GCC pop_options
+#endif
+
+#endif
+
+// Returns a set of kernels, which the host must be able to run
+inline const Kernels &GetKernels( KernelLevel level ) {
+    static const Kernels kernels[KERNEL_LEVEL_COUNT] = {
+        { "scalar", ScalarDecodeTile, ScalarColorTile, ScalarBlendLine },
+        #ifdef PGU_SIMD
+        { "ssse3", Sse2DecodeTile, Ssse3ColorTile, Ssse3BlendLine },
+        { "avx2", Avx2DecodeTile, Avx2ColorTile, Avx2BlendLine },
+        #endif
+    };
+    return kernels[level];
+}
+
+// Returns the best set of kernels this host runs
+inline KernelLevel BestKernelLevel() {
+    #ifdef PGU_SIMD
+    static const KernelLevel level =
+        __builtin_cpu_supports( "avx2" ) ? KERNELS_AVX2 :
+        __builtin_cpu_supports( "ssse3" ) ? KERNELS_SSSE3 : KERNELS_SCALAR;
+    return level;
+    #else
+    return KERNELS_SCALAR;
+    #endif
+}
+
+}
+
+#endif
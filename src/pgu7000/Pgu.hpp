@@ -24,7 +24,12 @@
 #define PGU_HPP
 
 #include "bob3000/Bob.hpp"
+#include "pgu7000/Kernels.hpp"
+#ifdef MIDI16_HEADLESS
+#include "MiDi16/HeadlessDisplay16.hpp"
+#else
 #include "MiDi16/MicroDisplay16.hpp"
+#endif
 
 // Pixel Graphics Unit
 
@@ -48,12 +53,44 @@ constexpr int
     PALETTE_ENTRY_COUNT      = 16,
     PALETTE_SIZE             = 1 + PALETTE_ENTRY_SIZE * PALETTE_ENTRY_COUNT,
 
+    // Object attribute memory stuff
+    OAM_ENTRY_SIZE           = 4, // x, y, sprite, attributes
+    OAM_ENTRY_COUNT          = 64,
+    OAM_SIZE                 = OAM_ENTRY_SIZE * OAM_ENTRY_COUNT,
+    OAM_OFFSET               = SPRITE_WIDTH, // Added to stored positions
+
     // Memory locations
     SPRITESHEET              = 0x3000,
     NAMETABLE0               =
         SPRITESHEET + SPRITESHEET_SPRITE_COUNT * SPRITE_SIZE,
     NAMETABLE1               = NAMETABLE0 + NAMETABLE_SIZE,
-    PALETTE                  = NAMETABLE1 + NAMETABLE_SIZE;
+    PALETTE                  = NAMETABLE1 + NAMETABLE_SIZE,
+    CONTROL                  = PALETTE + 0x40, // See Control
+    SCROLL_X                 = CONTROL + 1, // Background scroll in pixels
+    OAM                      = 0x3D00,
+
+    // Everything the PGU reads
+    VIDEO_MEMORY             = SPRITESHEET,
+    VIDEO_MEMORY_SIZE        = OAM + OAM_SIZE - VIDEO_MEMORY;
+
+static_assert(
+    SPRITE_WIDTH == TILE_WIDTH && SPRITE_SIZE == TILE_BITPLANE_SIZE,
+    "Sprites are not the kernels' tiles"
+);
+
+// Bits of the CONTROL byte
+enum Control {
+    CONTROL_BACKGROUND = 1 << 0, // Draw the nametables
+    CONTROL_SPRITES    = 1 << 1, // Draw the sprites in OAM
+};
+
+// Bits of the attributes byte of an OAM entry
+enum Attributes {
+    ATTRIBUTE_PALETTE = 0x0F,
+    ATTRIBUTE_FLIP_X  = 1 << 4,
+    ATTRIBUTE_FLIP_Y  = 1 << 5,
+};
+
 
 
 
@@ -77,6 +114,7 @@ public:
     // Sets the memory just like the CPU
     void SetMemory( Bob3k *memory ) {
         bob = memory;
+        latchAll = true;
 
         // Hard coded sprite
         bob->Write( SPRITESHEET + 0,  0b01000010 );
@@ -104,14 +142,57 @@ public:
         bob->Write( PALETTE + 3, PEACH );
     }
 
+    // Copies the video memory written to since the last frame, or all of it
+    // after SetMemory(), for drawing the frame. Runs once a frame, before the
+    // console clears the dirty map.
+    void Latch();
+
+    // Draws the layers turned on in CONTROL
+    void Render();
+
+    // Draws both nametables, scrolled left by SCROLL_X pixels and wrapping
+    // around, over the whole screen
+    void RenderBackground();
+
+    // Draws the sprites in OAM, the first entry on top, leaving the pixels
+    // of palette index 0 alone
+    void RenderObjects();
+
     // Given sprite coordinates and a palette, renders a sprite at the given
     // position
     void RenderSprite( uint8_t sprite, uint8_t palette, int x, int y );
 
+    // Picks the kernels sprites are decoded and drawn with, which default to
+    // the best this host runs
+    void SetKernels( KernelLevel level ) {
+        kernels = &GetKernels( level );
+        latchAll = true;
+    }
+
 private:
     MiDi16::Surface *screen;
     Bob3k *bob;
 
+    // Video memory as of the last Latch()
+    uint8_t video[VIDEO_MEMORY_SIZE];
+    bool latchAll = true;
+
+    // The latched sprites decoded into a palette index per pixel, row by
+    // row, as they are and flipped left to right
+    alignas( 8 ) uint8_t
+        tiles[SPRITESHEET_SPRITE_COUNT][SPRITE_WIDTH][SPRITE_WIDTH];
+    alignas( 8 ) uint8_t
+        flippedTiles[SPRITESHEET_SPRITE_COUNT][SPRITE_WIDTH][SPRITE_WIDTH];
+    const Kernels *kernels = &GetKernels( BestKernelLevel() );
+
+    // The latched palettes resolved into the colors their indices draw
+    alignas( 16 ) MiDi16::Color paletteColors[PALETTE_ENTRY_COUNT][4];
+
+    // The OAM entries of the frame that are on the screen, and a bit for
+    // each entry on every scanline
+    LineSprite objects[OAM_ENTRY_COUNT];
+    uint64_t scanlineObjects[SCREEN_RESOLUTION];
+
     // https://lospec.com/palette-list/anb16
     const MiDi16::Color colors[COLOR_COUNT] = {
         { 0x0A, 0x08, 0x0D, 0xFF }, { 0x69, 0x75, 0x94, 0xFF },
@@ -124,45 +205,249 @@ private:
         { 0x9E, 0x52, 0x52, 0xFF }, { 0x4D, 0x25, 0x36, 0xFF },
     };
 
-    // Sets a color at a given position
-    void SetPixel( uint8_t color, int x, int y ) {
-        screen->Set( x, y, colors[color] );
+    // Returns a byte of the latched video memory
+    uint8_t Video( uint16_t address ) const {
+        return video[address - VIDEO_MEMORY];
     }
+
+    // Returns the color index of a palette's entry, where 0 is the
+    // background color
+    uint8_t PaletteColor( uint8_t palette, int paletteIndex ) const {
+        if ( paletteIndex == 0 )
+            return Video( PALETTE );
+        return Video(
+            PALETTE + 1 + palette % PALETTE_ENTRY_COUNT * PALETTE_ENTRY_SIZE +
+            paletteIndex
+        );
+    }
+
+    // Decodes the latched bitplanes of a run of sprites into tiles
+    void DecodeSprites( int first, int count );
+
+    // Resolves the latched palette memory into paletteColors
+    void ResolvePalettes();
+
+    // Draws the 8 scanlines of a row of nametable entries
+    void RenderBackgroundRow( int row );
 };
 
 
+// Copies the video memory written to since the last frame
+void PixelGraphicsUnit::Latch() {
+    const uint8_t *memory = bob->data();
+
+    int offset = 0;
+    while ( offset < VIDEO_MEMORY_SIZE ) {
+        // Up to the end of the address's dirty block
+        uint16_t address = VIDEO_MEMORY + offset;
+        int size = BOB3K_DIRTY_BLOCK_SIZE - address % BOB3K_DIRTY_BLOCK_SIZE;
+        if ( size > VIDEO_MEMORY_SIZE - offset )
+            size = VIDEO_MEMORY_SIZE - offset;
+
+        if ( latchAll || bob->IsDirty( address, size ) ) {
+            memcpy( video + offset, memory + address, size );
+
+            // Blocks hold whole sprites
+            if ( address < NAMETABLE0 )
+                DecodeSprites(
+                    ( address - SPRITESHEET ) / SPRITE_SIZE,
+                    size / SPRITE_SIZE
+                );
+            if ( address < PALETTE + PALETTE_SIZE && address + size > PALETTE )
+                ResolvePalettes();
+        }
+        offset += size;
+    }
+    latchAll = false;
+}
+
+
+// Resolves the latched palette memory into paletteColors
+void PixelGraphicsUnit::ResolvePalettes() {
+    for ( int palette = 0; palette < PALETTE_ENTRY_COUNT; palette++ )
+        for ( int i = 0; i < 4; i++ )
+            paletteColors[palette][i] =
+                colors[PaletteColor( palette, i ) % COLOR_COUNT];
+}
+
+
+// Decodes the latched bitplanes of a run of sprites into tiles
+void PixelGraphicsUnit::DecodeSprites( int first, int count ) {
+    for ( int sprite = first; sprite < first + count; sprite++ ) {
+        kernels->DecodeTile(
+            video + SPRITESHEET - VIDEO_MEMORY + sprite * SPRITE_SIZE,
+            tiles[sprite][0]
+        );
+
+        for ( int j = 0; j < SPRITE_WIDTH; j++ ) {
+            uint64_t row;
+            memcpy( &row, tiles[sprite][j], sizeof( row ) );
+            row = __builtin_bswap64( row );
+            memcpy( flippedTiles[sprite][j], &row, sizeof( row ) );
+        }
+    }
+}
+
+
+// Draws the layers turned on in CONTROL
+void PixelGraphicsUnit::Render() {
+    if ( Video( CONTROL ) & CONTROL_BACKGROUND )
+        RenderBackground();
+    if ( Video( CONTROL ) & CONTROL_SPRITES )
+        RenderObjects();
+}
+
+
+// Draws both nametables over the whole screen
+void PixelGraphicsUnit::RenderBackground() {
+    int rows = screen->height() / SPRITE_WIDTH;
+    if ( rows > NAMETABLE_WIDTH )
+        rows = NAMETABLE_WIDTH;
+
+    for ( int row = 0; row < rows; row++ )
+        RenderBackgroundRow( row );
+}
+
+
+// Draws the 8 scanlines of a row of nametable entries. The row is decoded a
+// whole tile at a time into a line buffer one tile wider than the screen,
+// and copied out from the fine scroll
+void PixelGraphicsUnit::RenderBackgroundRow( int row ) {
+    constexpr int TILES = NAMETABLE_WIDTH + 1;
+    MiDi16::Color lines[SPRITE_WIDTH][TILES * SPRITE_WIDTH];
+
+    uint8_t scroll = Video( SCROLL_X );
+    int firstColumn = scroll / SPRITE_WIDTH;
+
+    for ( int tile = 0; tile < TILES; tile++ ) {
+        // NAMETABLE1 sits to the right of NAMETABLE0
+        int column = ( firstColumn + tile ) % ( NAMETABLE_WIDTH * 2 );
+        uint16_t nametable =
+            column < NAMETABLE_WIDTH ? NAMETABLE0 : NAMETABLE1;
+        uint16_t entry = nametable + NAMETABLE_ENTRY_SIZE *
+            ( row * NAMETABLE_WIDTH + column % NAMETABLE_WIDTH );
+
+        uint8_t sprite = Video( entry ) % SPRITESHEET_SPRITE_COUNT;
+        uint8_t palette = Video( entry + 1 ) % PALETTE_ENTRY_COUNT;
+
+        kernels->ColorTile(
+            tiles[sprite][0], paletteColors[palette],
+            lines[0] + tile * SPRITE_WIDTH, TILES * SPRITE_WIDTH
+        );
+    }
+
+    int width = screen->width();
+    if ( width > SCREEN_RESOLUTION )
+        width = SCREEN_RESOLUTION;
+
+    for ( int j = 0; j < SPRITE_WIDTH; j++ )
+        memcpy(
+            screen->Row( row * SPRITE_WIDTH + j ),
+            lines[j] + scroll % SPRITE_WIDTH,
+            width * sizeof( MiDi16::Color )
+        );
+}
+
+
+// Draws the sprites in OAM. OAM is scanned once, clipping each sprite to the
+// screen and marking the scanlines it covers. Every scanline then blends the
+// rows of its sprites with one call to the kernels, from the last entry to
+// the first.
+void PixelGraphicsUnit::RenderObjects() {
+    int width = screen->width();
+    int height = screen->height();
+    if ( width > SCREEN_RESOLUTION )
+        width = SCREEN_RESOLUTION;
+    if ( height > SCREEN_RESOLUTION )
+        height = SCREEN_RESOLUTION;
+
+    memset( scanlineObjects, 0, height * sizeof( uint64_t ) );
+    for ( int entry = 0; entry < OAM_ENTRY_COUNT; entry++ ) {
+        uint16_t address = OAM + entry * OAM_ENTRY_SIZE;
+        int x = Video( address ) - OAM_OFFSET;
+        int y = Video( address + 1 ) - OAM_OFFSET;
+
+        int left = x < 0 ? -x : 0;
+        int top = y < 0 ? -y : 0;
+        int right = width - x;
+        int bottom = height - y;
+        if ( right > SPRITE_WIDTH )
+            right = SPRITE_WIDTH;
+        if ( bottom > SPRITE_WIDTH )
+            bottom = SPRITE_WIDTH;
+        if ( left >= right || top >= bottom )
+            continue;
+
+        uint8_t sprite = Video( address + 2 ) % SPRITESHEET_SPRITE_COUNT;
+        uint8_t attributes = Video( address + 3 );
+        const uint8_t *tile = attributes & ATTRIBUTE_FLIP_X ?
+            flippedTiles[sprite][0] : tiles[sprite][0];
+
+        LineSprite &object = objects[entry];
+        object.x = x;
+        object.y = y;
+        object.left = left;
+        object.right = right;
+        object.rows = tile;
+        object.step = SPRITE_WIDTH;
+        if ( attributes & ATTRIBUTE_FLIP_Y ) {
+            object.rows = tile + ( SPRITE_WIDTH - 1 ) * SPRITE_WIDTH;
+            object.step = -SPRITE_WIDTH;
+        }
+        object.colors = paletteColors[attributes & ATTRIBUTE_PALETTE];
+
+        for ( int line = y + top; line < y + bottom; line++ )
+            scanlineObjects[line] |= (uint64_t)1 << entry;
+    }
+
+    for ( int line = 0; line < height; line++ )
+        if ( scanlineObjects[line] )
+            kernels->BlendLine(
+                objects, scanlineObjects[line], line, screen->Row( line )
+            );
+}
+
+
 // Given sprite coordinates and a palette, renders a sprite at the given
-// position
+// position. A sprite that is all on the screen is drawn by the kernels, one
+// that is not is clipped once and copied a row at a time.
 void PixelGraphicsUnit::RenderSprite(
     uint8_t sprite,
     uint8_t palette,
     int x, int y
 ) {
-    uint16_t spriteAddress = SPRITESHEET + sprite * SPRITE_SIZE;
-    uint16_t paletteAddress = PALETTE + 1 + palette * PALETTE_ENTRY_SIZE;
-
-    for ( int j = 0; j < SPRITE_WIDTH; j++ ) {
-        uint16_t rowAddress = spriteAddress + j;
-        uint8_t lsb = bob->Read( rowAddress ); // Least significant bit
-        uint8_t msb = bob->Read( rowAddress + SPRITE_WIDTH );
-
-        // Iterate through the bits
-        for ( int i = SPRITE_WIDTH - 1; i > -1; i-- ) {
-            uint8_t paletteIndex = ( ( msb & 1 ) << 1 ) | ( lsb & 1 );
-            lsb >>= 1;
-            msb >>= 1;
-
-            uint8_t colorIndex;
-            if ( paletteIndex == 0 )
-                colorIndex = bob->Read( PALETTE );
-            else
-                colorIndex = bob->Read( paletteAddress + paletteIndex );
-
-            SetPixel( colorIndex, x + i, y + j );
-        }
+    const uint8_t ( *tile )[SPRITE_WIDTH] =
+        tiles[sprite % SPRITESHEET_SPRITE_COUNT];
+    const MiDi16::Color *tileColors =
+        paletteColors[palette % PALETTE_ENTRY_COUNT];
+
+    // The part of the sprite on the screen
+    int left = x < 0 ? -x : 0;
+    int top = y < 0 ? -y : 0;
+    int right = screen->width() - x;
+    int bottom = screen->height() - y;
+    if ( right > SPRITE_WIDTH )
+        right = SPRITE_WIDTH;
+    if ( bottom > SPRITE_WIDTH )
+        bottom = SPRITE_WIDTH;
+
+    if (
+        left == 0 && top == 0 &&
+        right == SPRITE_WIDTH && bottom == SPRITE_WIDTH
+    ) {
+        MiDi16::Color *pixels = screen->Row( y ) + x;
+        kernels->ColorTile(
+            tile[0], tileColors, pixels, screen->Row( y + 1 ) + x - pixels
+        );
+        return;
     }
-}
 
+    for ( int j = top; j < bottom; j++ ) {
+        MiDi16::Color *row = screen->Row( y + j );
+        for ( int i = left; i < right; i++ )
+            row[x + i] = tileColors[tile[j][i]];
+    }
+}
 }
 
 
@@ -0,0 +1,187 @@
+/*
+* Copyright © 2025 Micro-16 Team
+* 
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the “Software”), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+* 
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+* 
+* THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+
+#ifndef REPLAY_HPP
+#define REPLAY_HPP
+
+// Records the input a console saw on every frame, starting from a save state,
+// so that the same session can be played back exactly without a window. The
+// CPU only sees input through memory, so replaying the inputs from the same
+// state reproduces the run bit for bit.
+//
+// File layout:
+//     RecordingHeader
+//     BYTE state[btp::STATE_SIZE] // Save state taken when recording started
+//     MiDi16::Input frames[count]
+
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "stdint.h"
+#include "string.h"
+
+#include "../bob3000/Bob.hpp"
+#include "../btp6000/Btp.hpp"
+#include "../btp6000/SaveState.hpp"
+#include "../MiDi16/Input16.hpp"
+
+#define RECORDING_MAGIC   "M16R"
+#define RECORDING_VERSION 3
+
+// Replay namespace
+namespace replay {
+
+// The input has a page of its own, away from the interrupt table and the
+// PGU's memory
+constexpr uint16_t
+    INPUT_DOWN    = 0x3E00, // Key down bitmap, copied in before every frame
+    INPUT_PRESSED = INPUT_DOWN + MiDi16::INPUT_BITMAP_SIZE; // Pressed bitmap
+
+static_assert(
+    ( INPUT_PRESSED + MiDi16::INPUT_BITMAP_SIZE - 1 ) >> 8 == INPUT_DOWN >> 8,
+    "the input bitmaps do not fit in one page"
+);
+static_assert(
+    INPUT_DOWN >> 8 != btp::INTERRUPT_PAGE,
+    "the input bitmaps share the interrupt page"
+);
+
+// Copies a frame's input into memory where the CPU can read it
+inline void WriteInput( const MiDi16::Input &input, Bob3k &memory ) {
+    memory.CopyIn( INPUT_DOWN, input.down, sizeof( input.down ) );
+    memory.CopyIn( INPUT_PRESSED, input.pressed, sizeof( input.pressed ) );
+}
+
+// Comes first in a recording file
+struct RecordingHeader {
+    char magic[4];      // RECORDING_MAGIC
+    uint16_t version;   // RECORDING_VERSION
+    uint16_t inputSize; // sizeof( MiDi16::Input )
+    uint32_t count;     // Frames recorded
+};
+
+// A starting state and the input of every frame after it
+class Recording {
+public:
+    std::vector<uint8_t> state;
+    std::vector<MiDi16::Input> frames;
+
+    // Empty constructor
+    Recording() {}
+
+    // Forgets the old recording and starts a new one from the current state
+    void Start( btp::BetterThanPico &cpu, const Bob3k &memory ) {
+        state.resize( btp::STATE_SIZE );
+        btp::SaveState( cpu, memory, state.data() );
+        frames.clear();
+    }
+
+    // Returns true once Start() or Load() has been called
+    bool IsStarted() const {
+        return !state.empty();
+    }
+
+    // Adds a frame's input
+    void Record( const MiDi16::Input &input ) {
+        frames.push_back( input );
+    }
+
+    // Forgets the newest frame, for when the console rewinds
+    void Rewind() {
+        if ( !frames.empty() )
+            frames.pop_back();
+    }
+
+    // Puts the console back in the state the recording started from,
+    // returns false if there is none
+    bool Restore( btp::BetterThanPico &cpu, Bob3k &memory ) const {
+        return btp::LoadState( cpu, memory, state.data(), state.size() );
+    }
+
+    // Writes the recording to a file, returns false if it could not be
+    // written
+    bool Save( const std::string &outputFile ) const;
+
+    // Reads a recording, prints the problem and returns false if it cannot be
+    // read
+    bool Load( const std::string &inputFile );
+};
+
+// Writes the recording to a file, returns false if it could not be written
+inline bool Recording::Save( const std::string &outputFile ) const {
+    RecordingHeader header;
+    memcpy( header.magic, RECORDING_MAGIC, sizeof( header.magic ) );
+    header.version = RECORDING_VERSION;
+    header.inputSize = sizeof( MiDi16::Input );
+    header.count = frames.size();
+
+    std::ofstream file( outputFile, std::ios::binary );
+    file.write( (const char*)&header, sizeof( header ) );
+    file.write( (const char*)state.data(), state.size() );
+    file.write(
+        (const char*)frames.data(), frames.size() * sizeof( MiDi16::Input )
+    );
+    return (bool)file;
+}
+
+// Reads a recording, prints the problem and returns false if it cannot be
+// read
+inline bool Recording::Load( const std::string &inputFile ) {
+    std::ifstream file( inputFile, std::ios::binary );
+    if ( !file.is_open() ) {
+        std::cout << "File \"" << inputFile << "\" either does not exist or "
+            "cannot be opened.\n";
+        return false;
+    }
+
+    RecordingHeader header;
+    file.read( (char*)&header, sizeof( header ) );
+    if (
+        !file ||
+        memcmp( header.magic, RECORDING_MAGIC, sizeof( header.magic ) ) ||
+        header.version != RECORDING_VERSION ||
+        header.inputSize != sizeof( MiDi16::Input )
+    ) {
+        std::cout << "ERROR: \"" << inputFile << "\" is not a recording!\n";
+        return false;
+    }
+
+    state.resize( btp::STATE_SIZE );
+    frames.resize( header.count );
+    file.read( (char*)state.data(), state.size() );
+    file.read(
+        (char*)frames.data(), frames.size() * sizeof( MiDi16::Input )
+    );
+    if ( !file ) {
+        std::cout << "ERROR: \"" << inputFile << "\" is cut short!\n";
+        return false;
+    }
+    return true;
+}
+
+}
+
+#endif